@@ -0,0 +1,45 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/**
+ * Nanoseconds from an arbitrary steady epoch. Used to stamp benchmark elements and tasks.
+ */
+inline int64_t nowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Queue element of Size_ bytes, which carries the moment when it was created.
+ */
+template <size_t Size_>
+struct Payload {
+	int64_t timestampNs;
+	std::array<char, Size_ - sizeof(int64_t)> data;
+
+	Payload() : timestampNs(0), data() { }
+	explicit Payload(int64_t timestampNs) : timestampNs(timestampNs), data() { }
+};
+
+template <>
+struct Payload<sizeof(int64_t)> {
+	int64_t timestampNs;
+
+	Payload() : timestampNs(0) { }
+	explicit Payload(int64_t timestampNs) : timestampNs(timestampNs) { }
+};
+
+/**
+ * Spins with yield until the counter drops to zero.
+ */
+inline void awaitZero(const std::atomic<int64_t>& counter) {
+	while (counter.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+}
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,105 @@
+#include "benchmark/benchmark.h"
+#include "benchutil.h"
+#include "adaptiveconditionvariable.h"
+#include "blockingdequeue.h"
+#include "lockfreedequeue.h"
+#include "ringbuffer.h"
+#include "shardedblockingdequeue.h"
+#include "spscdequeue.h"
+
+/**
+ * Producers_ threads put elements and Consumers_ threads take them, capacity of the queue is the benchmark argument.
+ * Every iteration each producer puts Consumers_ elements and each consumer takes Producers_ elements, so both sides do
+ * the same amount of work. Reported latency is the average put to take time.
+ */
+template <typename Dequeue_, int Producers_, int Consumers_>
+static void BM_DequeueTransfer(benchmark::State& state) {
+	typedef typename Dequeue_::ValueType Element;
+	static Dequeue_* dequeue = nullptr;
+
+	if (state.thread_index() == 0) dequeue = new Dequeue_(static_cast<size_t>(state.range(0)));
+	const bool isProducer = state.thread_index() < Producers_;
+	int64_t latencySumNs = 0;
+
+	for (auto _ : state) {
+		if (isProducer) {
+			for (int i = 0; i < Consumers_; ++i) dequeue->put(Element(nowNs()));
+		} else {
+			for (int i = 0; i < Producers_; ++i) {
+				Element element = dequeue->take();
+				latencySumNs += nowNs() - element.timestampNs;
+			}
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * (isProducer ? Consumers_ : Producers_));
+	if (!isProducer) {
+		double latency = static_cast<double>(latencySumNs) / static_cast<double>(state.iterations() * Producers_);
+		state.counters["latency_ns"] = benchmark::Counter(latency / Consumers_);
+	}
+	if (state.thread_index() == 0) {
+		delete dequeue;
+		dequeue = nullptr;
+	}
+}
+
+#define DEQUEUE_BENCHMARK(Dequeue, Size, Producers, Consumers) \
+	BENCHMARK_TEMPLATE(BM_DequeueTransfer, Dequeue<Payload<Size>>, Producers, Consumers) \
+		->ArgName("capacity")->Arg(16)->Arg(1024)->Threads((Producers) + (Consumers))->UseRealTime()
+
+#define DEQUEUE_BENCHMARK_TOPOLOGIES(Dequeue, Size) \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 1, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 3, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 2, 2); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 4, 4)
+
+/**
+ * Many producers and one consumer, shows how put throughput scales with the number of producers.
+ */
+#define DEQUEUE_BENCHMARK_PRODUCER_SCALING(Dequeue, Size) \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 1, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 4, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 8, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 16, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 32, 1); \
+	DEQUEUE_BENCHMARK(Dequeue, Size, 8, 4)
+
+template <typename T>
+using BlockingDequeueOf = BlockingDequeue<T>;
+
+template <typename T>
+using CompactBlockingDequeueOf = BlockingDequeue<T, std::deque, std::condition_variable, DequeueLayout::compact>;
+
+template <typename T>
+using RingBlockingDequeueOf = BlockingDequeue<T, RingBuffer>;
+
+template <typename T>
+using ShardedBlockingDequeueOf = ShardedBlockingDequeue<T>;
+
+template <typename T>
+using AdaptiveBlockingDequeueOf = BlockingDequeue<T, std::deque, AdaptiveConditionVariable<>>;
+
+DEQUEUE_BENCHMARK_TOPOLOGIES(BlockingDequeueOf, 8);
+DEQUEUE_BENCHMARK_TOPOLOGIES(BlockingDequeueOf, 64);
+DEQUEUE_BENCHMARK_TOPOLOGIES(BlockingDequeueOf, 256);
+
+DEQUEUE_BENCHMARK_TOPOLOGIES(CompactBlockingDequeueOf, 8);
+DEQUEUE_BENCHMARK_TOPOLOGIES(CompactBlockingDequeueOf, 64);
+
+DEQUEUE_BENCHMARK_TOPOLOGIES(RingBlockingDequeueOf, 8);
+DEQUEUE_BENCHMARK_TOPOLOGIES(RingBlockingDequeueOf, 64);
+DEQUEUE_BENCHMARK_TOPOLOGIES(RingBlockingDequeueOf, 256);
+
+DEQUEUE_BENCHMARK_TOPOLOGIES(AdaptiveBlockingDequeueOf, 8);
+DEQUEUE_BENCHMARK_TOPOLOGIES(AdaptiveBlockingDequeueOf, 64);
+
+DEQUEUE_BENCHMARK_PRODUCER_SCALING(BlockingDequeueOf, 64);
+DEQUEUE_BENCHMARK_PRODUCER_SCALING(ShardedBlockingDequeueOf, 64);
+
+DEQUEUE_BENCHMARK_TOPOLOGIES(LockFreeDequeue, 8);
+DEQUEUE_BENCHMARK_TOPOLOGIES(LockFreeDequeue, 64);
+DEQUEUE_BENCHMARK_TOPOLOGIES(LockFreeDequeue, 256);
+
+DEQUEUE_BENCHMARK(SpscDequeue, 8, 1, 1);
+DEQUEUE_BENCHMARK(SpscDequeue, 64, 1, 1);
+DEQUEUE_BENCHMARK(SpscDequeue, 256, 1, 1);
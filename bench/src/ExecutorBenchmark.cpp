@@ -0,0 +1,121 @@
+#include "benchmark/benchmark.h"
+#include "benchutil.h"
+#include "executor.h"
+#include "workstealingexecutor.h"
+
+#include <vector>
+
+static const int TASK_BATCH = 1000;
+
+/**
+ * Executes batches of empty tasks on a pool of range(0) threads and waits for every batch to complete. Reported
+ * latency is the average time from execute() call to the task start.
+ */
+template <typename Executor_>
+static void BM_ExecuteThroughput(benchmark::State& state) {
+	Executor_ executor(static_cast<size_t>(state.range(0)));
+	std::atomic<int64_t> pending(0), latencySumNs(0);
+
+	for (auto _ : state) {
+		pending.store(TASK_BATCH);
+		for (int i = 0; i < TASK_BATCH; ++i) {
+			int64_t submitNs = nowNs();
+			executor.execute([&pending, &latencySumNs, submitNs]() {
+				latencySumNs.fetch_add(nowNs() - submitNs, std::memory_order_relaxed);
+				pending.fetch_sub(1, std::memory_order_release);
+			});
+		}
+		awaitZero(pending);
+	}
+
+	int64_t tasks = state.iterations() * TASK_BATCH;
+	state.SetItemsProcessed(tasks);
+	state.counters["latency_ns"] = benchmark::Counter(static_cast<double>(latencySumNs.load()) / static_cast<double>(tasks));
+}
+
+/**
+ * Same as BM_ExecuteThroughput, but every batch is queued with one executeAll() call. Reported latency is the average
+ * time from the executeAll() call to the task start.
+ */
+template <typename Executor_>
+static void BM_ExecuteAllThroughput(benchmark::State& state) {
+	Executor_ executor(static_cast<size_t>(state.range(0)));
+	std::atomic<int64_t> pending(0), latencySumNs(0), submitNs(0);
+	auto task = [&pending, &latencySumNs, &submitNs]() {
+		latencySumNs.fetch_add(nowNs() - submitNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		pending.fetch_sub(1, std::memory_order_release);
+	};
+	std::vector<decltype(task)> batch(TASK_BATCH, task);
+
+	for (auto _ : state) {
+		pending.store(TASK_BATCH);
+		submitNs.store(nowNs(), std::memory_order_relaxed);
+		executor.executeAll(batch.begin(), batch.end());
+		awaitZero(pending);
+	}
+
+	int64_t tasks = state.iterations() * TASK_BATCH;
+	state.SetItemsProcessed(tasks);
+	state.counters["latency_ns"] = benchmark::Counter(static_cast<double>(latencySumNs.load()) / static_cast<double>(tasks));
+}
+
+/**
+ * Submits batches of tasks on a pool of range(0) threads and waits for all of their futures. Reported latency is the
+ * average time from submit() call to the task start.
+ */
+template <typename Executor_>
+static void BM_SubmitThroughput(benchmark::State& state) {
+	Executor_ executor(static_cast<size_t>(state.range(0)));
+	std::vector<std::future<int64_t>> futures;
+	futures.reserve(TASK_BATCH);
+	int64_t latencySumNs = 0;
+
+	for (auto _ : state) {
+		for (int i = 0; i < TASK_BATCH; ++i) {
+			int64_t submitNs = nowNs();
+			futures.push_back(executor.submit([submitNs]() { return nowNs() - submitNs; }));
+		}
+		for (auto& future : futures) latencySumNs += future.get();
+		futures.clear();
+	}
+
+	int64_t tasks = state.iterations() * TASK_BATCH;
+	state.SetItemsProcessed(tasks);
+	state.counters["latency_ns"] = benchmark::Counter(static_cast<double>(latencySumNs) / static_cast<double>(tasks));
+}
+
+/**
+ * Same as BM_SubmitThroughput, but with submit(use_future, callable), which returns Future instead of std::future.
+ */
+template <typename Executor_>
+static void BM_SubmitFutureThroughput(benchmark::State& state) {
+	Executor_ executor(static_cast<size_t>(state.range(0)));
+	std::vector<Future<int64_t>> futures;
+	futures.reserve(TASK_BATCH);
+	int64_t latencySumNs = 0;
+
+	for (auto _ : state) {
+		for (int i = 0; i < TASK_BATCH; ++i) {
+			int64_t submitNs = nowNs();
+			futures.push_back(executor.submit(use_future, [submitNs]() { return nowNs() - submitNs; }));
+		}
+		for (auto& future : futures) latencySumNs += future.get();
+		futures.clear();
+	}
+
+	int64_t tasks = state.iterations() * TASK_BATCH;
+	state.SetItemsProcessed(tasks);
+	state.counters["latency_ns"] = benchmark::Counter(static_cast<double>(latencySumNs) / static_cast<double>(tasks));
+}
+
+#define EXECUTOR_BENCHMARK(Benchmark, Executor) \
+	BENCHMARK_TEMPLATE(Benchmark, Executor)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime()
+
+EXECUTOR_BENCHMARK(BM_ExecuteThroughput, ThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_ExecuteAllThroughput, ThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_SubmitThroughput, ThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_SubmitFutureThroughput, ThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_ExecuteThroughput, InstrumentedThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_SubmitThroughput, InstrumentedThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_ExecuteThroughput, WorkStealingThreadPoolExecutor);
+EXECUTOR_BENCHMARK(BM_SubmitThroughput, WorkStealingThreadPoolExecutor);
@@ -0,0 +1,94 @@
+#include "benchmark/benchmark.h"
+#include "executor.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+static const size_t ELEMENTS = 1 << 20;
+
+static std::vector<double> randomValues() {
+	std::mt19937 random(42);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::vector<double> values(ELEMENTS);
+	for (auto& value : values) value = distribution(random);
+	return values;
+}
+
+/**
+ * Serial baselines: std:: algorithms over ELEMENTS doubles.
+ */
+static void BM_SerialTransform(benchmark::State& state) {
+	std::vector<double> in = randomValues(), out(ELEMENTS);
+	for (auto _ : state) {
+		std::transform(in.begin(), in.end(), out.begin(), [](double x) { return std::sqrt(x) * 2.0; });
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+static void BM_SerialReduce(benchmark::State& state) {
+	std::vector<double> in = randomValues();
+	for (auto _ : state) benchmark::DoNotOptimize(std::accumulate(in.begin(), in.end(), 0.0));
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+static void BM_SerialSort(benchmark::State& state) {
+	std::vector<double> in = randomValues(), values;
+	for (auto _ : state) {
+		values = in;
+		std::sort(values.begin(), values.end());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+/**
+ * Parallel algorithms on a pool of range(0) threads, the calling thread helps.
+ */
+static void BM_ParallelTransform(benchmark::State& state) {
+	ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+	std::vector<double> in = randomValues(), out(ELEMENTS);
+	for (auto _ : state) {
+		parallelTransform(executor, in.begin(), in.end(), out.begin(), [](double x) { return std::sqrt(x) * 2.0; });
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+static void BM_ParallelFor(benchmark::State& state) {
+	ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+	std::vector<double> in = randomValues(), out(ELEMENTS);
+	for (auto _ : state) {
+		parallelFor(executor, size_t(0), ELEMENTS, [&](size_t i) { out[i] = std::sqrt(in[i]) * 2.0; });
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+static void BM_ParallelReduce(benchmark::State& state) {
+	ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+	std::vector<double> in = randomValues();
+	for (auto _ : state) benchmark::DoNotOptimize(parallelReduce(executor, in.begin(), in.end(), 0.0));
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+static void BM_ParallelSort(benchmark::State& state) {
+	ThreadPoolExecutor executor(static_cast<size_t>(state.range(0)));
+	std::vector<double> in = randomValues(), values;
+	for (auto _ : state) {
+		values = in;
+		parallelSort(executor, values.begin(), values.end());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ELEMENTS));
+}
+
+BENCHMARK(BM_SerialTransform)->UseRealTime();
+BENCHMARK(BM_SerialReduce)->UseRealTime();
+BENCHMARK(BM_SerialSort)->UseRealTime();
+BENCHMARK(BM_ParallelTransform)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_ParallelFor)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_ParallelReduce)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
+BENCHMARK(BM_ParallelSort)->ArgName("threads")->RangeMultiplier(2)->Range(1, 8)->UseRealTime();
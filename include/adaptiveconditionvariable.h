@@ -0,0 +1,140 @@
+#ifndef ADAPTIVECONDITIONVARIABLE_H
+#define ADAPTIVECONDITIONVARIABLE_H
+
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Counters of the phase in which waits of AdaptiveConditionVariable were satisfied.
+ */
+struct AdaptiveWaitStats {
+	uint64_t spinWakeups;
+	uint64_t yieldWakeups;
+	uint64_t parkWakeups;
+	uint64_t timeouts;
+};
+
+/**
+ * @brief Condition variable which waits in three phases: it spins with pause instructions up to SpinCount_ iterations
+ * watching for notifications, then yields the processor up to YieldCount_ times, and only then parks on
+ * std::condition_variable. Notifications make a system call only if some waiter is parked.
+ *
+ * Can be used as ConditionVariable_ of BlockingDequeue for queues where wake-up latency matters more than CPU time of
+ * waiting threads.
+ */
+template <int SpinCount_ = 2000, int YieldCount_ = 16>
+class AdaptiveConditionVariable {
+public:
+	AdaptiveConditionVariable() : epoch(0), parked(0), spin_wakeups(0), yield_wakeups(0), park_wakeups(0), timeouts(0) { }
+
+	AdaptiveConditionVariable(const AdaptiveConditionVariable&) = delete;
+	AdaptiveConditionVariable& operator=(const AdaptiveConditionVariable&) = delete;
+
+	/**
+	 * @brief Blocks until pred returns true. The lock must be held by the calling thread, the predicate is always
+	 * checked under the lock.
+	 */
+	template<typename Predicate>
+	void wait(std::unique_lock<std::mutex>& lock, Predicate pred) {
+		if (pred()) return;
+		if (spin(lock, pred, nullptr)) return;
+		parked.fetch_add(1);
+		cond.wait(lock, pred);
+		parked.fetch_sub(1);
+		park_wakeups.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Blocks until pred returns true or the timeout elapses.
+	 *
+	 * @return the last result of pred
+	 */
+	template<typename Rep, typename Period, typename Predicate>
+	bool wait_for(std::unique_lock<std::mutex>& lock, const std::chrono::duration<Rep, Period>& timeout, Predicate pred) {
+		if (pred()) return true;
+		Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+		if (spin(lock, pred, &deadline)) return true;
+		if (Clock::now() >= deadline) {
+			timeouts.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		parked.fetch_add(1);
+		bool isOk = cond.wait_until(lock, deadline, pred);
+		parked.fetch_sub(1);
+		(isOk ? park_wakeups : timeouts).fetch_add(1, std::memory_order_relaxed);
+		return isOk;
+	}
+
+	void notify_one() {
+		epoch.fetch_add(1, std::memory_order_release);
+		if (parked.load() != 0) cond.notify_one();
+	}
+
+	void notify_all() {
+		epoch.fetch_add(1, std::memory_order_release);
+		if (parked.load() != 0) cond.notify_all();
+	}
+
+	/**
+	 * @brief Returns how many waits were satisfied in each phase and how many timed out.
+	 */
+	AdaptiveWaitStats stats() const {
+		AdaptiveWaitStats s;
+		s.spinWakeups = spin_wakeups.load(std::memory_order_relaxed);
+		s.yieldWakeups = yield_wakeups.load(std::memory_order_relaxed);
+		s.parkWakeups = park_wakeups.load(std::memory_order_relaxed);
+		s.timeouts = timeouts.load(std::memory_order_relaxed);
+		return s;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Runs spin and yield phases. The lock is released while waiting and held again when pred is checked.
+	 *
+	 * @return true if pred became true
+	 */
+	template<typename Predicate>
+	bool spin(std::unique_lock<std::mutex>& lock, Predicate& pred, const Clock::time_point* deadline) {
+		for (int i = 0; i < SpinCount_;) {
+			uint32_t seen = epoch.load(std::memory_order_acquire);
+			lock.unlock();
+			while (i < SpinCount_ && epoch.load(std::memory_order_acquire) == seen) {
+				cpuRelax();
+				++i;
+			}
+			lock.lock();
+			if (pred()) {
+				spin_wakeups.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+			if (deadline && Clock::now() >= *deadline) return false;
+		}
+		for (int i = 0; i < YieldCount_; ++i) {
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+			if (pred()) {
+				yield_wakeups.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+			if (deadline && Clock::now() >= *deadline) return false;
+		}
+		return false;
+	}
+
+	std::atomic<uint32_t> epoch;
+	std::atomic<uint32_t> parked;
+	std::condition_variable cond;
+
+	char pad[CACHE_LINE_SIZE];
+	std::atomic<uint64_t> spin_wakeups, yield_wakeups, park_wakeups, timeouts;
+};
+
+#endif // ADAPTIVECONDITIONVARIABLE_H
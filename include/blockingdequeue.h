@@ -1,23 +1,77 @@
 #ifndef BLOCKINGDEQUEUE_H
 #define BLOCKINGDEQUEUE_H
 
+#include "coroutine.h"
+#include "platform.h"
+#include "selector.h"
+#include "slaballocator.h"
 #include <queue>
+#include <chrono>
 #include <condition_variable>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Storage layout of BlockingDequeue.
+ *
+ * - padded - the queue, the consumer-side wait state (condition variable and waiting takers) and the producer-side
+ * wait state are kept on separate cache lines, so notifying one side does not invalidate the line of the other
+ * - compact - fields are packed together, for many rarely contended queues
+ */
+enum class DequeueLayout {
+	padded,
+	compact
+};
+
+/**
+ * @brief Result of BlockingDequeue::takeStatus and BlockingDequeue::pollStatus.
+ *
+ * - ok - the element is retrieved
+ * - timeout - the waiting time elapsed before an element became available
+ * - closed - the queue is closed and drained, no element will come
+ */
+enum class DequeueStatus {
+	ok,
+	timeout,
+	closed
+};
+
+/**
+ * @brief Exception thrown by take() and awaitables when the queue is closed and drained.
+ */
+class DequeueClosedException: public std::runtime_error {
+public:
+	DequeueClosedException() : std::runtime_error("BlockingDequeue is closed") { }
+};
+
+/**
+ * @brief std::deque which takes its chunks from SlabAllocator, for Queue_ of BlockingDequeue. Chunks freed by consumers
+ * go back to the cache of the producer, so a busy queue stops calling malloc after warm-up.
+ */
+template <typename T, typename...>
+using SlabDeque = std::deque<T, SlabStdAllocator<T>>;
 
 /**
  * @brief A Queue that supports operations that wait for the queue to become non-empty when retrieving an element, and
  * wait for space to become available in the queue when storing an element.
+ *
+ * Queue_ is std::deque by default, RingBuffer keeps elements in one contiguous buffer which is reused when the size of
+ * the queue oscillates, SlabDeque allocates chunks from SlabAllocator.
  */
-template <typename T, template<typename = T, typename...> class Queue_ = std::deque, typename ConditionVariable_ = std::condition_variable>
+template <typename T, template<typename = T, typename...> class Queue_ = std::deque,
+          typename ConditionVariable_ = std::condition_variable, DequeueLayout Layout_ = DequeueLayout::padded>
 class BlockingDequeue {
 public:
+	typedef T ValueType;
 	typedef Queue_<T> QueueType;
 
 	/**
 	 * @brief Constructor
 	 */
 	explicit BlockingDequeue(size_t capacity = SIZE_MAX)
-			: cond_var_add(new ConditionVariable_()), cond_var_rem(new ConditionVariable_()), max_size(capacity) { }
+			: max_size(capacity), is_closed(false), waiting_takers(0), waiting_putters(0) { }
 
 	/**
 	 * @brief Copy constructor. Initialize queue with copy of other container elements. Not thread-safe for other queue.
@@ -42,28 +96,31 @@ public:
 		other.mutex.unlock();
 	}
 
-	~BlockingDequeue() {
-		delete cond_var_add;
-		delete cond_var_rem;
-	}
-
 	/**
 	 * @brief Inserts the specified element into this queue, waiting if necessary for space to become available.
 	 *
 	 * @param v the element to add
+	 * @return true if the element was added, false if the queue is closed
 	 */
 	template<typename Type>
-	void put(Type && v) {
-		mutex.lock();
-		cond_var_rem->wait(mutex, [&]() { return data_queue.size() < max_size; });
+	bool put(Type && v) {
+		std::unique_lock<std::mutex> lc(mutex);
+		++waiting_putters;
+		cond_var_rem.wait(lc, [&]() { return data_queue.size() < max_size || is_closed; });
+		--waiting_putters;
+		if (is_closed) return false;
 		data_queue.push_back(std::forward<Type>(v));
-		mutex.unlock();
-		cond_var_add->notify_one();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_add.notify_one();
+		postAsync(ready);
+		return true;
 	}
 
 	/**
 	 * @brief Inserts the specified element at the end of this queue if it is possible to do so immediately without
-	 * exceeding the queue's capacity, returning true upon success and false if this queue is full.
+	 * exceeding the queue's capacity, returning true upon success and false if this queue is full or closed.
 	 *
 	 * @param v the element to add
 	 * @return true if the element was added to this queue, else false
@@ -71,13 +128,16 @@ public:
 	template<typename Type>
 	bool offer(Type && v) {
 		mutex.lock();
-		if (data_queue.size() >= max_size) {
+		if (data_queue.size() >= max_size || is_closed) {
 			mutex.unlock();
 			return false;
 		}
 		data_queue.push_back(std::forward<Type>(v));
+		AsyncReady ready;
+		settleAsync(ready);
 		mutex.unlock();
-		cond_var_add->notify_one();
+		cond_var_add.notify_one();
+		postAsync(ready);
 		return true;
 	}
 
@@ -87,30 +147,106 @@ public:
 	 *
 	 * @param v the element to add
 	 * @param timeoutMs how long to wait before giving up, in milliseconds
-	 * @return true if successful, or false if the specified waiting time elapses before space is available
+	 * @return true if successful, or false if the specified waiting time elapses before space is available or the queue
+	 * is closed
 	 */
 	template<typename Type>
 	bool offer(Type && v, int timeoutMs) {
-		mutex.lock();
-		bool isOk = cond_var_rem->wait_for(mutex, timeoutMs, [&]() { return data_queue.size() < max_size; } );
+		std::unique_lock<std::mutex> lc(mutex);
+		++waiting_putters;
+		bool isOk = cond_var_rem.wait_for(lc, std::chrono::milliseconds(timeoutMs), [&]() { return data_queue.size() < max_size || is_closed; } );
+		--waiting_putters;
+		isOk = isOk && !is_closed;
 		if (isOk) data_queue.push_back(std::forward<Type>(v));
-		mutex.unlock();
-		if (isOk) cond_var_add->notify_one();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		if (isOk) cond_var_add.notify_one();
+		postAsync(ready);
 		return isOk;
 	}
 
+	/**
+	 * @brief Inserts all elements of the range into this queue, waiting if necessary for space to become available.
+	 * Elements are inserted under one lock acquisition per available space window, waiting consumers are notified
+	 * once per window. If the queue is closed, the remaining elements are not inserted.
+	 *
+	 * @param first, last the range of elements to add
+	 * @return the number of inserted elements, they are the first elements of the range, fewer than the size of the
+	 * range only if the queue is closed
+	 */
+	template<typename Iterator>
+	size_t putAll(Iterator first, Iterator last) {
+		std::unique_lock<std::mutex> lc(mutex);
+		size_t total = 0;
+		while (first != last) {
+			++waiting_putters;
+			cond_var_rem.wait(lc, [&]() { return data_queue.size() < max_size || is_closed; });
+			--waiting_putters;
+			if (is_closed) return total;
+			size_t count = 0;
+			for (; first != last && data_queue.size() < max_size; ++first, ++count) data_queue.push_back(*first);
+			total += count;
+			AsyncReady ready;
+			settleAsync(ready);
+			if (first != last) {
+				notifyWaiters(&cond_var_add, count, waiting_takers);
+				if (!ready.empty()) {
+					lc.unlock();
+					postAsync(ready);
+					lc.lock();
+				}
+			} else {
+				size_t waiting = waiting_takers;
+				lc.unlock();
+				notifyWaiters(&cond_var_add, count, waiting);
+				postAsync(ready);
+			}
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Inserts elements of the range into this queue while it is possible to do so immediately without exceeding
+	 * the queue's capacity. Elements are inserted under one lock acquisition.
+	 *
+	 * @param first, last the range of elements to add
+	 * @return the number of inserted elements, they are the first elements of the range, 0 if the queue is closed
+	 */
+	template<typename Iterator>
+	size_t offerAll(Iterator first, Iterator last) {
+		std::unique_lock<std::mutex> lc(mutex);
+		if (is_closed) return 0;
+		size_t count = 0;
+		for (; first != last && data_queue.size() < max_size; ++first, ++count) data_queue.push_back(*first);
+		AsyncReady ready;
+		settleAsync(ready);
+		size_t waiting = waiting_takers;
+		lc.unlock();
+		notifyWaiters(&cond_var_add, count, waiting);
+		postAsync(ready);
+		return count;
+	}
+
 	/**
 	 * @brief Retrieves and removes the head of this queue, waiting if necessary until an element becomes available.
 	 *
 	 * @return the head of this queue
+	 * @throw DequeueClosedException if the queue is closed and drained
 	 */
 	T take() {
-		mutex.lock();
-		cond_var_add->wait(mutex, [&]() { return data_queue.size() != 0; });
+		std::unique_lock<std::mutex> lc(mutex);
+		++waiting_takers;
+		cond_var_add.wait(lc, [&]() { return data_queue.size() != 0 || is_closed; });
+		--waiting_takers;
+		if (isDrainedLocked()) throw DequeueClosedException();
 		T t = std::move(data_queue.front());
 		data_queue.pop_front();
-		mutex.unlock();
-		cond_var_rem->notify_one();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_rem.notify_one();
+		postAsync(ready);
 		return t;
 	}
 
@@ -123,14 +259,19 @@ public:
 	 * @param isOk flag, which indicates result of method execution. It will be set to false if timeout, or true if
 	 * return value is retrieved value
 	 * @return the head of this queue, or defaultVal if the specified waiting time elapses before an element is available
+	 * or the queue is closed and drained
 	 */
 	template<typename Type = T>
 	T poll(int timeoutMs, Type && defaultVal = Type(), bool * isOk = nullptr) {
 		bool isNotEmpty;
 		T t;
+		AsyncReady ready;
 		{
 			std::unique_lock<std::mutex> lc(mutex);
-			isNotEmpty = cond_var_add->wait_for(lc, std::chrono::milliseconds(timeoutMs), [&]() { return data_queue.size() != 0; });
+			++waiting_takers;
+			isNotEmpty = cond_var_add.wait_for(lc, std::chrono::milliseconds(timeoutMs), [&]() { return data_queue.size() != 0 || is_closed; });
+			--waiting_takers;
+			isNotEmpty = isNotEmpty && !isDrainedLocked();
 
 			if (isNotEmpty) {
 				t = std::move(data_queue.front());
@@ -138,8 +279,10 @@ public:
 			} else {
 				t = std::forward<Type>(defaultVal);
 			}
+			settleAsync(ready);
 		}
-		if (isNotEmpty) cond_var_rem->notify_one();
+		if (isNotEmpty) cond_var_rem.notify_one();
+		postAsync(ready);
 		if (isOk) *isOk = isNotEmpty;
 		return t;
 	}
@@ -164,12 +307,117 @@ public:
 		} else {
 			t = std::forward<Type>(defaultVal);
 		}
+		AsyncReady ready;
+		settleAsync(ready);
 		mutex.unlock();
-		if (isNotEmpty) cond_var_rem->notifyOne();
+		if (isNotEmpty) cond_var_rem.notify_one();
+		postAsync(ready);
 		if (isOk) *isOk = isNotEmpty;
 		return t;
 	}
 
+	/**
+	 * @brief Retrieves and removes the head of this queue if it is not empty. Unlike poll, the element is moved into out,
+	 * so T needs no default value.
+	 *
+	 * @return true if the head was retrieved
+	 */
+	bool tryPoll(T& out) {
+		std::unique_lock<std::mutex> lc(mutex);
+		if (data_queue.size() == 0) return false;
+		out = std::move(data_queue.front());
+		data_queue.pop_front();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_rem.notify_one();
+		postAsync(ready);
+		return true;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue into out, waiting if necessary until an element becomes
+	 * available or the queue is closed.
+	 *
+	 * @return ok if out is set, closed if the queue is closed and drained
+	 */
+	DequeueStatus takeStatus(T& out) {
+		return pollStatus(out, -1);
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue into out, waiting up to the specified wait time if necessary.
+	 * Needs neither default value nor isOk flag, unlike poll(timeoutMs, defaultVal, isOk). It has its own name, so calls
+	 * of poll with two lvalues of T keep resolving to poll(timeoutMs, defaultVal).
+	 *
+	 * @param timeoutMs how long to wait before giving up, in milliseconds, negative to wait without timeout
+	 * @return ok if out is set, timeout if the time elapsed, closed if the queue is closed and drained
+	 */
+	DequeueStatus pollStatus(T& out, int timeoutMs) {
+		std::unique_lock<std::mutex> lc(mutex);
+		auto isReady = [&]() { return data_queue.size() != 0 || is_closed; };
+		++waiting_takers;
+		bool isOk = true;
+		if (timeoutMs < 0) cond_var_add.wait(lc, isReady);
+		else isOk = cond_var_add.wait_for(lc, std::chrono::milliseconds(timeoutMs), isReady);
+		--waiting_takers;
+		if (!isOk) return DequeueStatus::timeout;
+		if (isDrainedLocked()) return DequeueStatus::closed;
+
+		out = std::move(data_queue.front());
+		data_queue.pop_front();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_rem.notify_one();
+		postAsync(ready);
+		return DequeueStatus::ok;
+	}
+
+	/**
+	 * @brief Closes the queue: new elements are rejected, consumers take the remaining ones and then get closed status.
+	 * All waiting threads, coroutines and pollAny callers are woken up at once. Closing twice has no effect.
+	 */
+	void close() {
+		AsyncReady ready;
+		{
+			std::lock_guard<std::mutex> lc(mutex);
+			if (is_closed) return;
+			is_closed = true;
+			closeAsync(ready);
+			selectors.signalAll();
+		}
+		cond_var_add.notify_all();
+		cond_var_rem.notify_all();
+		postAsync(ready);
+	}
+
+	bool isClosed() {
+		std::lock_guard<std::mutex> lc(mutex);
+		return is_closed;
+	}
+
+	/**
+	 * @brief Returns true if the queue is closed and has no elements, so nothing can be taken from it any more.
+	 */
+	bool isDrained() {
+		std::lock_guard<std::mutex> lc(mutex);
+		return isDrainedLocked();
+	}
+
+	/**
+	 * @brief Registers selector of pollAny, which is signaled every time the queue changes while it is not empty.
+	 */
+	void attachSelector(SelectorNode* node) {
+		std::lock_guard<std::mutex> lc(mutex);
+		selectors.attach(node);
+	}
+
+	void detachSelector(SelectorNode* node) {
+		std::lock_guard<std::mutex> lc(mutex);
+		selectors.detach(node);
+	}
+
 	/**
 	 * @brief Returns the number of elements that this queue can ideally (in the absence of memory or resource
 	 * constraints) contains. This is always equal to the initial capacity of this queue less the current size of this queue.
@@ -212,13 +460,42 @@ public:
 	 */
 	template<typename Appendable>
 	size_t drainTo(Appendable& other, size_t maxCount = SIZE_MAX) {
-		mutex.lock();
-		size_t count = maxCount > data_queue.size() ? data_queue.size() : maxCount;
-		for (size_t i = 0; i < count; ++i) {
-			other.push_back(std::move(data_queue.front()));
-			data_queue.pop_front();
-		}
-		mutex.unlock();
+		std::unique_lock<std::mutex> lc(mutex);
+		size_t count = drainLocked(other, maxCount);
+		AsyncReady ready;
+		settleAsync(ready);
+		size_t waiting = waiting_putters;
+		lc.unlock();
+		notifyWaiters(&cond_var_rem, count, waiting);
+		postAsync(ready);
+		return count;
+	}
+
+	/**
+	 * @brief Removes up to maxCount elements from this queue and adds them to other given queue, waiting up to the
+	 * specified wait time if necessary for at least one element to become available. Elements are removed under one
+	 * lock acquisition.
+	 *
+	 * @param other the container to append elements to
+	 * @param maxCount the maximum number of elements to transfer
+	 * @param timeoutMs how long to wait before giving up, in milliseconds
+	 * @return the number of elements transferred, or 0 if the specified waiting time elapses or the queue is closed and
+	 * drained
+	 */
+	template<typename Appendable>
+	size_t takeBatch(Appendable& other, size_t maxCount, int timeoutMs) {
+		std::unique_lock<std::mutex> lc(mutex);
+		++waiting_takers;
+		bool isNotEmpty = cond_var_add.wait_for(lc, std::chrono::milliseconds(timeoutMs), [&]() { return data_queue.size() != 0 || is_closed; });
+		--waiting_takers;
+		if (!isNotEmpty || isDrainedLocked()) return 0;
+		size_t count = drainLocked(other, maxCount);
+		AsyncReady ready;
+		settleAsync(ready);
+		size_t waiting = waiting_putters;
+		lc.unlock();
+		notifyWaiters(&cond_var_rem, count, waiting);
+		postAsync(ready);
 		return count;
 	}
 
@@ -229,23 +506,312 @@ public:
 		mutex.lock();
 		other.mutex.lock();
 		size_t count = maxCount > data_queue.size() ? data_queue.size() : maxCount;
-		size_t otherRemainingCapacity = other.max_size - data_queue.size();
+		size_t otherRemainingCapacity = other.max_size - other.data_queue.size();
 		if (count > otherRemainingCapacity) count = otherRemainingCapacity;
 		for (size_t i = 0; i < count; ++i) {
 			other.data_queue.push_back(std::move(data_queue.front()));
 			data_queue.pop_front();
 		}
+		AsyncReady ready, otherReady;
+		settleAsync(ready);
+		other.settleAsync(otherReady);
+		size_t otherWaiting = other.waiting_takers, waiting = waiting_putters;
 		other.mutex.unlock();
 		mutex.unlock();
+		notifyWaiters(&other.cond_var_add, count, otherWaiting);
+		notifyWaiters(&cond_var_rem, count, waiting);
+		other.postAsync(otherReady);
+		postAsync(ready);
 		return count;
 	}
 
+#ifdef CONCURRENT_COROUTINES
+	/**
+	 * @brief Suspended coroutine with its element: the taken one for takers, the one to add for putters.
+	 */
+	struct ValueWaiter: AsyncWaiter {
+		ValueWaiter() : has_value(false), is_closed(false) { }
+		ValueWaiter(const ValueWaiter&) = delete;
+		ValueWaiter& operator=(const ValueWaiter&) = delete;
+
+		~ValueWaiter() {
+			if (has_value) value()->~T();
+		}
+
+		template<typename Type>
+		void emplace(Type&& v) {
+			new (&storage) T(std::forward<Type>(v));
+			has_value = true;
+		}
+
+		T* value() {
+			return reinterpret_cast<T*>(&storage);
+		}
+
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+		bool has_value;
+		bool is_closed;
+	};
+
+	/**
+	 * @brief Awaitable of asyncTake. The coroutine continues at once if the queue is not empty, otherwise it is
+	 * suspended without blocking the thread and resumed on the executor with the element handed over by a producer. If
+	 * the executor is shut down or rejects the resume task, the coroutine continues in the producer thread.
+	 */
+	template<typename Executor_>
+	class TakeAwaitable: private ValueWaiter {
+	public:
+		TakeAwaitable(BlockingDequeue& queue, Executor_& executor) : queue(queue), executor(executor) { }
+
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		bool await_suspend(std::coroutine_handle<> handle) {
+			this->handle = handle;
+			this->post = &TakeAwaitable::resume;
+			return queue.suspendTaker(this);
+		}
+
+		/**
+		 * @throw DequeueClosedException if the queue is closed and drained
+		 */
+		T await_resume() {
+			if (this->is_closed) throw DequeueClosedException();
+			return std::move(*this->value());
+		}
+
+	private:
+		static void resume(AsyncWaiter* waiter) {
+			ResumeTask::post(static_cast<TakeAwaitable*>(waiter)->executor, waiter->handle);
+		}
+
+		BlockingDequeue& queue;
+		Executor_& executor;
+	};
+
+	/**
+	 * @brief Awaitable of asyncPut. The coroutine continues at once if the queue has space, otherwise it is suspended
+	 * and resumed on the executor after a consumer moved the element into the queue, or in the consumer thread if the
+	 * executor is shut down or rejects the resume task.
+	 */
+	template<typename Executor_>
+	class PutAwaitable: private ValueWaiter {
+	public:
+		template<typename Type>
+		PutAwaitable(BlockingDequeue& queue, Executor_& executor, Type&& v) : queue(queue), executor(executor) {
+			this->emplace(std::forward<Type>(v));
+		}
+
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		bool await_suspend(std::coroutine_handle<> handle) {
+			this->handle = handle;
+			this->post = &PutAwaitable::resume;
+			return queue.suspendPutter(this);
+		}
+
+		/**
+		 * @throw DequeueClosedException if the queue is closed, the element is not added
+		 */
+		void await_resume() const {
+			if (this->is_closed) throw DequeueClosedException();
+		}
+
+	private:
+		static void resume(AsyncWaiter* waiter) {
+			ResumeTask::post(static_cast<PutAwaitable*>(waiter)->executor, waiter->handle);
+		}
+
+		BlockingDequeue& queue;
+		Executor_& executor;
+	};
+
+	/**
+	 * @brief Retrieves and removes the head of this queue, suspending the coroutine until an element becomes available.
+	 * Suspended takers are served in FIFO order and resumed on the executor, which must outlive them.
+	 *
+	 * @return awaitable, co_await of which yields the head of this queue
+	 */
+	template<typename Executor_>
+	TakeAwaitable<Executor_> asyncTake(Executor_& executor) {
+		return TakeAwaitable<Executor_>(*this, executor);
+	}
+
+	/**
+	 * @brief Inserts the specified element into this queue, suspending the coroutine until space becomes available.
+	 * Suspended putters are served in FIFO order and resumed on the executor, which must outlive them.
+	 */
+	template<typename Executor_, typename Type>
+	PutAwaitable<Executor_> asyncPut(Executor_& executor, Type&& v) {
+		return PutAwaitable<Executor_>(*this, executor, std::forward<Type>(v));
+	}
+
+#endif // CONCURRENT_COROUTINES
+
 protected:
+#ifdef CONCURRENT_COROUTINES
+	typedef AsyncWaiterList AsyncReady;
+
+	/**
+	 * @return false if the element is taken at once, true if the waiter is queued and the coroutine stays suspended
+	 */
+	bool suspendTaker(ValueWaiter* waiter) {
+		std::unique_lock<std::mutex> lc(mutex);
+		if (isDrainedLocked()) {
+			waiter->is_closed = true;
+			return false;
+		}
+		if (data_queue.size() == 0) {
+			async_takers.push(waiter);
+			return true;
+		}
+		waiter->emplace(std::move(data_queue.front()));
+		data_queue.pop_front();
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_rem.notify_one();
+		postAsync(ready);
+		return false;
+	}
+
+	/**
+	 * @return false if the element is added at once, true if the waiter is queued and the coroutine stays suspended
+	 */
+	bool suspendPutter(ValueWaiter* waiter) {
+		std::unique_lock<std::mutex> lc(mutex);
+		if (is_closed) {
+			waiter->is_closed = true;
+			return false;
+		}
+		if (data_queue.size() >= max_size) {
+			async_putters.push(waiter);
+			return true;
+		}
+		data_queue.push_back(std::move(*waiter->value()));
+		AsyncReady ready;
+		settleAsync(ready);
+		lc.unlock();
+		cond_var_add.notify_one();
+		postAsync(ready);
+		return false;
+	}
+
+	/**
+	 * @brief Called under the lock after the queue changed. Hands elements to suspended takers and adds elements of
+	 * suspended putters while there is space, served waiters are moved to ready. Then signals selectors if elements are
+	 * left.
+	 */
+	void settleAsync(AsyncReady& ready) {
+		for (;;) {
+			if (!async_takers.empty() && data_queue.size() != 0) {
+				ValueWaiter* waiter = static_cast<ValueWaiter*>(async_takers.pop());
+				waiter->emplace(std::move(data_queue.front()));
+				data_queue.pop_front();
+				ready.push(waiter);
+			} else if (!async_putters.empty() && data_queue.size() < max_size) {
+				ValueWaiter* waiter = static_cast<ValueWaiter*>(async_putters.pop());
+				data_queue.push_back(std::move(*waiter->value()));
+				ready.push(waiter);
+			} else {
+				break;
+			}
+		}
+		signalSelectors();
+	}
+
+	/**
+	 * @brief Called under the lock by close. Suspended putters are rejected; suspended takers wait only while the queue
+	 * is empty, so they get closed status at once.
+	 */
+	void closeAsync(AsyncReady& ready) {
+		AsyncWaiterList closed;
+		closed.append(async_putters);
+		closed.append(async_takers);
+		while (!closed.empty()) {
+			ValueWaiter* waiter = static_cast<ValueWaiter*>(closed.pop());
+			waiter->is_closed = true;
+			ready.push(waiter);
+		}
+	}
+
+	/**
+	 * @brief Called after the lock is released. Resumes served waiters; the queue changed for waiting threads too, so
+	 * they are woken up to recheck it.
+	 */
+	void postAsync(AsyncReady& ready) {
+		if (ready.empty()) return;
+		cond_var_add.notify_all();
+		cond_var_rem.notify_all();
+		ready.postAll();
+	}
+#else
+	struct AsyncReady {
+		bool empty() const { return true; }
+	};
+
+	void settleAsync(AsyncReady&) {
+		signalSelectors();
+	}
+
+	void closeAsync(AsyncReady&) { }
+
+	void postAsync(AsyncReady&) { }
+#endif // CONCURRENT_COROUTINES
+
+	bool isDrainedLocked() {
+		return is_closed && data_queue.size() == 0;
+	}
+
+	void signalSelectors() {
+		if (!selectors.empty() && data_queue.size() != 0) selectors.signalAll();
+	}
+
+	template<typename Appendable>
+	size_t drainLocked(Appendable& other, size_t maxCount) {
+		size_t count = maxCount > data_queue.size() ? data_queue.size() : maxCount;
+		for (size_t i = 0; i < count; ++i) {
+			other.push_back(std::move(data_queue.front()));
+			data_queue.pop_front();
+		}
+		return count;
+	}
+
+	/**
+	 * @brief Wakes up to count of waiting threads with one notify_all if all of them should wake up, otherwise with
+	 * count notify_one calls.
+	 */
+	static void notifyWaiters(ConditionVariable_* cond_var, size_t count, size_t waiting) {
+		if (count == 0 || waiting == 0) return;
+		if (count >= waiting) cond_var->notify_all();
+		else for (size_t i = 0; i < count; ++i) cond_var->notify_one();
+	}
+
+	static const bool IS_PADDED = Layout_ == DequeueLayout::padded;
+
 	std::mutex mutex;
-	// TODO change to type without point
-	ConditionVariable_ *cond_var_add, *cond_var_rem;
 	QueueType data_queue;
 	size_t max_size;
+	bool is_closed;
+	SelectorList selectors;
+	CacheLinePad<IS_PADDED> pad0;
+	// Consumer side: producers notify, consumers wait
+	ConditionVariable_ cond_var_add;
+	size_t waiting_takers;
+#ifdef CONCURRENT_COROUTINES
+	AsyncWaiterList async_takers;
+#endif
+	CacheLinePad<IS_PADDED> pad1;
+	// Producer side: consumers notify, producers wait
+	ConditionVariable_ cond_var_rem;
+	size_t waiting_putters;
+#ifdef CONCURRENT_COROUTINES
+	AsyncWaiterList async_putters;
+#endif
+	CacheLinePad<IS_PADDED> pad2;
 
 };
 
@@ -0,0 +1,161 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+/**
+ * @brief C++20 coroutine support, compiled only with CONCURRENT_COROUTINES defined (CMake option of the same name).
+ * Without it the header is empty and the library stays C++11.
+ */
+#ifdef CONCURRENT_COROUTINES
+
+#if !defined(__cpp_impl_coroutine)
+#error "CONCURRENT_COROUTINES requires a C++20 compiler with coroutine support"
+#endif
+
+#include <coroutine>
+#include <exception>
+
+/**
+ * @brief Coroutine suspended in a queue. The queue links waiters into an intrusive FIFO list, so suspension does not
+ * allocate, and calls post to resume the coroutine on its executor.
+ */
+struct AsyncWaiter {
+	AsyncWaiter* next = nullptr;
+	std::coroutine_handle<> handle;
+	void (*post)(AsyncWaiter*) = nullptr;
+};
+
+/**
+ * @brief Intrusive FIFO list of waiters. Not thread-safe, guarded by the mutex of the owner.
+ */
+class AsyncWaiterList {
+public:
+	bool empty() const {
+		return head == nullptr;
+	}
+
+	void push(AsyncWaiter* waiter) {
+		waiter->next = nullptr;
+		if (tail) tail->next = waiter;
+		else head = waiter;
+		tail = waiter;
+	}
+
+	AsyncWaiter* pop() {
+		AsyncWaiter* waiter = head;
+		head = waiter->next;
+		if (!head) tail = nullptr;
+		waiter->next = nullptr;
+		return waiter;
+	}
+
+	/**
+	 * @brief Moves all waiters of other to the end of this list.
+	 */
+	void append(AsyncWaiterList& other) {
+		while (!other.empty()) push(other.pop());
+	}
+
+	/**
+	 * @brief Posts all waiters to their executors and clears the list. An executor which throws on rejection does not
+	 * stop the other waiters from being posted, the rejected coroutine has been resumed inline by then, see ResumeTask.
+	 */
+	void postAll() {
+		while (!empty()) {
+			AsyncWaiter* waiter = pop();
+			try {
+				waiter->post(waiter);
+			} catch (...) { }
+		}
+	}
+
+private:
+	AsyncWaiter* head = nullptr;
+	AsyncWaiter* tail = nullptr;
+};
+
+/**
+ * @brief Task which resumes the coroutine. If the task is destroyed without being run, e.g. dropped by a rejection
+ * policy or by an executor which is shut down, it resumes the coroutine in the destroying thread, so a coroutine
+ * which has already been handed its element is never leaked.
+ */
+class ResumeTask {
+public:
+	explicit ResumeTask(std::coroutine_handle<> handle) : handle(handle) { }
+
+	ResumeTask(ResumeTask&& other) noexcept : handle(other.handle) {
+		other.handle = nullptr;
+	}
+
+	ResumeTask(const ResumeTask&) = delete;
+	ResumeTask& operator=(const ResumeTask&) = delete;
+
+	~ResumeTask() {
+		if (handle) handle.resume();
+	}
+
+	void operator()() {
+		std::coroutine_handle<> h = handle;
+		handle = nullptr;
+		h.resume();
+	}
+
+	/**
+	 * @brief Resumes the coroutine on the executor, or in the calling thread if the executor is shut down or rejects
+	 * the task.
+	 */
+	template<typename Executor_>
+	static void post(Executor_& executor, std::coroutine_handle<> handle) {
+		if (executor.isShutdown()) {
+			handle.resume();
+			return;
+		}
+		executor.execute(ResumeTask(handle));
+	}
+
+private:
+	std::coroutine_handle<> handle;
+};
+
+/**
+ * @brief Awaitable returned by executor.schedule(): suspends the coroutine and resumes it on a worker of the executor.
+ * If the executor is shut down, the coroutine continues in the calling thread. A resume task dropped by a rejection
+ * policy leaves the coroutine suspended, so use block or caller_runs policy for executors which run coroutines.
+ */
+template <typename Executor_>
+class ScheduleAwaitable {
+public:
+	explicit ScheduleAwaitable(Executor_& executor) : executor(executor) { }
+
+	bool await_ready() const noexcept {
+		return false;
+	}
+
+	bool await_suspend(std::coroutine_handle<> handle) {
+		if (executor.isShutdown()) return false;
+		executor.execute([handle]() { handle.resume(); });
+		return true;
+	}
+
+	void await_resume() const noexcept { }
+
+private:
+	Executor_& executor;
+};
+
+/**
+ * @brief Return type of fire-and-forget coroutines: the coroutine starts at once and destroys itself when it finishes.
+ * An exception escaping the coroutine calls std::terminate, as for a thread function.
+ */
+struct DetachedTask {
+	struct promise_type {
+		DetachedTask get_return_object() noexcept { return DetachedTask(); }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+		std::suspend_never final_suspend() noexcept { return {}; }
+		void return_void() noexcept { }
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+};
+
+#endif // CONCURRENT_COROUTINES
+
+#endif // COROUTINE_H
@@ -0,0 +1,298 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/**
+ * @brief Logical CPU with its place in the machine topology.
+ */
+struct CpuInfo {
+	int cpu;
+	int core;
+	int package;
+	int node;
+};
+
+/**
+ * @brief Logical CPUs of the machine grouped by cores, packages and NUMA nodes. On Linux it is read from sysfs, on
+ * other systems or without sysfs all CPUs are reported as separate cores of node 0.
+ */
+class CpuTopology {
+public:
+	CpuTopology() { }
+
+	explicit CpuTopology(std::vector<CpuInfo> cpus) : cpu_infos(std::move(cpus)) {
+		for (const CpuInfo& info : cpu_infos) {
+			if (std::find(node_ids.begin(), node_ids.end(), info.node) == node_ids.end()) node_ids.push_back(info.node);
+		}
+		std::sort(node_ids.begin(), node_ids.end());
+	}
+
+	/**
+	 * @brief Returns topology of CPUs which the calling process is allowed to run on.
+	 */
+	static CpuTopology detect() {
+		CpuTopology topology = parse("/sys/devices/system");
+		std::vector<int> allowed = allowedCpus();
+		if (allowed.empty()) return topology;
+
+		std::vector<CpuInfo> cpus;
+		for (const CpuInfo& info : topology.cpus()) {
+			if (std::find(allowed.begin(), allowed.end(), info.cpu) != allowed.end()) cpus.push_back(info);
+		}
+		return cpus.empty() ? topology : CpuTopology(cpus);
+	}
+
+	/**
+	 * @brief Reads topology from sysfs mounted at sysfsRoot: cpu/online, cpu/cpuN/topology/{core_id,
+	 * physical_package_id}, node/online and node/nodeN/cpulist. Missing files get default values.
+	 */
+	static CpuTopology parse(const std::string& sysfsRoot) {
+		std::vector<int> online = parseCpuList(readFile(sysfsRoot + "/cpu/online"));
+		if (online.empty()) {
+			unsigned count = std::thread::hardware_concurrency();
+			for (unsigned cpu = 0; cpu < (count == 0 ? 1 : count); ++cpu) online.push_back(static_cast<int>(cpu));
+		}
+
+		std::vector<CpuInfo> cpus;
+		for (int cpu : online) {
+			std::string topologyDir = sysfsRoot + "/cpu/cpu" + std::to_string(cpu) + "/topology/";
+			CpuInfo info;
+			info.cpu = cpu;
+			info.core = readInt(topologyDir + "core_id", cpu);
+			info.package = readInt(topologyDir + "physical_package_id", 0);
+			info.node = 0;
+			cpus.push_back(info);
+		}
+
+		for (int node : parseCpuList(readFile(sysfsRoot + "/node/online"))) {
+			std::string nodeCpus = readFile(sysfsRoot + "/node/node" + std::to_string(node) + "/cpulist");
+			for (int cpu : parseCpuList(nodeCpus)) {
+				for (CpuInfo& info : cpus) {
+					if (info.cpu == cpu) info.node = node;
+				}
+			}
+		}
+		return CpuTopology(cpus);
+	}
+
+	/**
+	 * @brief Parses sysfs CPU list format, e.g. "0-3,8,10-11".
+	 */
+	static std::vector<int> parseCpuList(const std::string& list) {
+		std::vector<int> cpus;
+		std::stringstream stream(list);
+		std::string range;
+		while (std::getline(stream, range, ',')) {
+			size_t dash = range.find('-');
+			try {
+				int first = std::stoi(range.substr(0, dash));
+				int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+				for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+			} catch (const std::exception&) {
+				// Skip malformed range
+			}
+		}
+		return cpus;
+	}
+
+	const std::vector<CpuInfo>& cpus() const {
+		return cpu_infos;
+	}
+
+	/**
+	 * @brief Returns NUMA node ids in ascending order.
+	 */
+	const std::vector<int>& nodes() const {
+		return node_ids;
+	}
+
+	std::vector<int> cpusOfNode(int node) const {
+		std::vector<int> result;
+		for (const CpuInfo& info : cpu_infos) {
+			if (info.node == node) result.push_back(info.cpu);
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Returns NUMA node of the CPU, or -1 if the CPU is unknown.
+	 */
+	int nodeOf(int cpu) const {
+		for (const CpuInfo& info : cpu_infos) {
+			if (info.cpu == cpu) return info.node;
+		}
+		return -1;
+	}
+
+private:
+	static std::string readFile(const std::string& path) {
+		std::ifstream file(path);
+		std::string content;
+		std::getline(file, content);
+		return content;
+	}
+
+	static int readInt(const std::string& path, int defaultVal) {
+		try {
+			return std::stoi(readFile(path));
+		} catch (const std::exception&) {
+			return defaultVal;
+		}
+	}
+
+	static std::vector<int> allowedCpus() {
+		std::vector<int> cpus;
+#ifdef __linux__
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+		for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+		}
+#endif
+		return cpus;
+	}
+
+	std::vector<CpuInfo> cpu_infos;
+	std::vector<int> node_ids;
+};
+
+/**
+ * @brief Order in which workers are pinned to CPUs, worker i runs on cpus(topology)[i % size].
+ *
+ * - compact - fills all hardware threads of a core, then the next core of the same package and node
+ * - scatter - spreads workers over nodes, then over cores, sibling hardware threads are used last
+ * - explicit_list - given CPU list
+ */
+class CpuPlacement {
+public:
+	enum policy_t {
+		compact,
+		scatter,
+		explicit_list
+	};
+
+	explicit CpuPlacement(policy_t policy = compact) : policy(policy) { }
+
+	explicit CpuPlacement(std::vector<int> cpus) : policy(explicit_list), cpu_list(std::move(cpus)) { }
+
+	std::vector<int> cpus(const CpuTopology& topology) const {
+		if (policy == explicit_list) return cpu_list;
+
+		std::vector<CpuInfo> sorted = topology.cpus();
+		std::sort(sorted.begin(), sorted.end(), [](const CpuInfo& a, const CpuInfo& b) {
+			if (a.node != b.node) return a.node < b.node;
+			if (a.package != b.package) return a.package < b.package;
+			if (a.core != b.core) return a.core < b.core;
+			return a.cpu < b.cpu;
+		});
+
+		std::vector<int> result;
+		if (policy == compact) {
+			for (const CpuInfo& info : sorted) result.push_back(info.cpu);
+			return result;
+		}
+
+		// Rank is (hardware thread index in core, core index in node, node index)
+		struct Ranked {
+			size_t thread, core, node;
+			int cpu;
+		};
+		std::vector<Ranked> ranked;
+		size_t nodeIndex = 0, coreIndex = 0, threadIndex = 0;
+		for (size_t i = 0; i < sorted.size(); ++i) {
+			if (i > 0) {
+				const CpuInfo& prev = sorted[i - 1];
+				if (prev.node != sorted[i].node) {
+					++nodeIndex;
+					coreIndex = threadIndex = 0;
+				} else if (prev.package != sorted[i].package || prev.core != sorted[i].core) {
+					++coreIndex;
+					threadIndex = 0;
+				} else {
+					++threadIndex;
+				}
+			}
+			ranked.push_back(Ranked{threadIndex, coreIndex, nodeIndex, sorted[i].cpu});
+		}
+		std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+			if (a.thread != b.thread) return a.thread < b.thread;
+			if (a.core != b.core) return a.core < b.core;
+			return a.node < b.node;
+		});
+		for (const Ranked& r : ranked) result.push_back(r.cpu);
+		return result;
+	}
+
+private:
+	policy_t policy;
+	std::vector<int> cpu_list;
+};
+
+#ifdef __linux__
+inline bool toCpuSet(const std::vector<int>& cpus, cpu_set_t& set) {
+	if (cpus.empty()) return false;
+	CPU_ZERO(&set);
+	for (int cpu : cpus) {
+		if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+		CPU_SET(static_cast<size_t>(cpu), &set);
+	}
+	return true;
+}
+#endif
+
+/**
+ * @brief Pins the thread to the given CPUs.
+ *
+ * @return true on success, false if CPU list is empty, contains unavailable CPUs or affinity is not supported
+ */
+inline bool setThreadAffinity(std::thread& thread, const std::vector<int>& cpus) {
+#ifdef __linux__
+	cpu_set_t set;
+	if (!toCpuSet(cpus, set)) return false;
+	return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+	(void) thread;
+	(void) cpus;
+	return false;
+#endif
+}
+
+/**
+ * @brief Pins the calling thread to the given CPUs with sched_setaffinity.
+ */
+inline bool setCurrentThreadAffinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+	cpu_set_t set;
+	if (!toCpuSet(cpus, set)) return false;
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	(void) cpus;
+	return false;
+#endif
+}
+
+/**
+ * @brief Returns CPU the calling thread runs on, or -1 if it is unknown.
+ */
+inline int currentCpu() {
+#ifdef __linux__
+	return sched_getcpu();
+#else
+	return -1;
+#endif
+}
+
+#endif // CPUTOPOLOGY_H
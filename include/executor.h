@@ -2,48 +2,106 @@
 #define EXECUTOR_H
 
 #include "blockingdequeue.h"
+#include "coroutine.h"
+#include "executorstats.h"
+#include "executortracer.h"
+#include "functionwrapper.h"
+#include "future.h"
 #include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 /**
- * @brief Wrapper for custom invoke operator available function types.
- * @note Source from: "Энтони Уильямс, Параллельное программирование на С++ в действии. Практика разработки многопоточных
- * программ. Пер. с англ. Слинкин А. А. - M.: ДМК Пресс, 2012 - 672c.: ил." (page 387)
+ * @brief What execute and submit do with a task when the task queue is full.
+ *
+ * - block - wait for space in the queue, the task is dropped as by discard if shutdown closes the queue meanwhile
+ * - caller_runs - run the task in the calling thread
+ * - discard_oldest - drop the oldest queued task and queue the new one
+ * - discard - drop the task, future of submit gets std::future_error with broken_promise
+ * - abort - throw RejectedExecutionException
  */
-class FunctionWrapper {
-	struct ImplBase {
-		virtual void call() = 0;
-		virtual ~ImplBase() = default;
-	};
+enum class RejectionPolicy {
+	block,
+	caller_runs,
+	discard_oldest,
+	discard,
+	abort
+};
 
-	std::unique_ptr<ImplBase> impl;
+/**
+ * @brief Exception thrown by execute and submit when the task is rejected with RejectionPolicy::abort.
+ */
+class RejectedExecutionException: public std::runtime_error {
+public:
+	RejectedExecutionException() : std::runtime_error("Task rejected: executor queue is full") { }
+};
 
-	template<typename F>
-	struct ImplType: ImplBase {
-		F f;
-		explicit ImplType(F&& f): f(std::forward<F>(f)) {}
-		void call() final { f(); }
-	};
+/**
+ * @brief Task of submit: calls f and sets its result or exception to std::promise. Unlike std::packaged_task, the
+ * shared state of the promise is allocated with SlabStdAllocator, so submit does not call malloc in the steady state.
+ */
+template <typename R, typename F>
+class SubmitTask {
 public:
-	template<typename F, typename = std::enable_if<!std::is_same<F, FunctionWrapper>::value> >
-	explicit FunctionWrapper(F&& f): impl(new ImplType<F>(std::forward<F>(f))) {}
+	template<typename Type>
+	explicit SubmitTask(Type&& f) : promise(std::allocator_arg, SlabStdAllocator<R>()), f(std::forward<Type>(f)) { }
+
+	SubmitTask(SubmitTask&& other) = default;
 
-	void operator()() { impl->call(); }
+	std::future<R> getFuture() {
+		return promise.get_future();
+	}
 
-	explicit operator bool() const noexcept { return static_cast<bool>(impl); }
+	void operator()() {
+		try {
+			callAndSet(std::is_void<R>());
+		} catch (...) {
+			promise.set_exception(std::current_exception());
+		}
+	}
+
+private:
+	void callAndSet(std::true_type) {
+		f();
+		promise.set_value();
+	}
 
-	FunctionWrapper() = default;
-	FunctionWrapper(FunctionWrapper&& other) noexcept : impl(std::move(other.impl)) {}
-	FunctionWrapper& operator=(FunctionWrapper&& other) noexcept {
-		impl = std::move(other.impl);
-		return *this;
+	void callAndSet(std::false_type) {
+		promise.set_value(f());
 	}
 
-	FunctionWrapper(const FunctionWrapper& other) = delete;
-	FunctionWrapper& operator=(const FunctionWrapper&) = delete;
+	std::promise<R> promise;
+	F f;
 };
 
-template <typename Thread_ = std::thread, typename Dequeue_ = BlockingDequeue<FunctionWrapper>>
+/**
+ * @brief Callable type and result type of a range of callables passed to submitAll.
+ */
+template <typename Range>
+struct BatchResult {
+	typedef typename std::decay<decltype(*std::begin(std::declval<Range&>()))>::type Function;
+	typedef typename std::result_of<Function()>::type type;
+};
+
+/**
+ * @brief Thread pool. Stats_ is NoExecutorStats by default, which compiles the instrumentation out; ExecutorStats
+ * enables it, see snapshot(). Likewise Tracer_ is NoExecutorTracer by default, ExecutorTracer records timestamps of
+ * every task, see traceEvents() and writeTrace(). Dequeue_ has the interface of BlockingDequeue, including close(),
+ * takeStatus() and pollStatus(): shutdown closes the queue and workers leave when it is drained.
+ */
+template <typename Thread_ = std::thread, typename Dequeue_ = BlockingDequeue<FunctionWrapper, SlabDeque>, typename Stats_ = NoExecutorStats,
+          typename Tracer_ = NoExecutorTracer>
 class ThreadPoolExecutorTemplate {
 protected:
 	enum thread_command {
@@ -53,11 +111,28 @@ protected:
 	};
 
 public:
-	explicit ThreadPoolExecutorTemplate(size_t corePoolSize = 1) : thread_command_(thread_command::run) { makePool(corePoolSize); }
+	typedef typename Dequeue_::ValueType Task;
+	typedef std::function<void(Task&&)> RejectionHandler;
+
+	explicit ThreadPoolExecutorTemplate(size_t corePoolSize = 1)
+			: ThreadPoolExecutorTemplate(corePoolSize, corePoolSize, 0, [](Thread_*){}) { }
+
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t queueCapacity, RejectionPolicy rejectionPolicy)
+			: ThreadPoolExecutorTemplate(corePoolSize, corePoolSize, 0, queueCapacity, rejectionPolicy, [](Thread_*){}) { }
+
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs)
+			: ThreadPoolExecutorTemplate(corePoolSize, maximumPoolSize, keepAliveMs, [](Thread_*){}) { }
+
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, size_t queueCapacity,
+	                           RejectionPolicy rejectionPolicy)
+			: ThreadPoolExecutorTemplate(corePoolSize, maximumPoolSize, keepAliveMs, queueCapacity, rejectionPolicy,
+			                             [](Thread_*){}) { }
 
 	virtual ~ThreadPoolExecutorTemplate() {
 		shutdownNow();
-		awaitTermination(1000);
+		stopManager();
+		joinPool();
+		joinRetired();
 		while (threadPool.size() > 0) {
 			auto thread = threadPool.back();
 			threadPool.pop_back();
@@ -70,10 +145,10 @@ public:
 		typedef typename std::result_of<FunctionType()>::type ResultType;
 
 		if (thread_command_ == thread_command::run) {
-			std::packaged_task<ResultType()> callable_task(std::forward<FunctionType>(callable));
-			auto future = callable_task.get_future();
-			FunctionWrapper functionWrapper(callable_task);
-			taskQueue.offer(std::move(functionWrapper));
+			SubmitTask<ResultType, typename std::decay<FunctionType>::type> callable_task(
+					std::forward<FunctionType>(callable));
+			auto future = callable_task.getFuture();
+			enqueue(Task(wrapTask(std::move(callable_task))));
 			return future;
 		} else {
 			return std::future<ResultType>();
@@ -83,17 +158,109 @@ public:
 	template<typename FunctionType>
 	void execute(FunctionType&& runnable) {
 		if (thread_command_ == thread_command::run) {
-			FunctionWrapper function_wrapper(std::forward<FunctionType>(runnable));
-			taskQueue.offer(std::move(function_wrapper));
+			enqueue(Task(wrapTask(std::forward<FunctionType>(runnable))));
 		}
 	}
 
+	template<typename FunctionType>
+	std::future<typename std::result_of<FunctionType()>::type> submit(int priority, FunctionType&& callable) {
+		typedef typename std::result_of<FunctionType()>::type ResultType;
+
+		if (thread_command_ == thread_command::run) {
+			SubmitTask<ResultType, typename std::decay<FunctionType>::type> callable_task(
+					std::forward<FunctionType>(callable));
+			auto future = callable_task.getFuture();
+			enqueue(Task(priority, wrapTask(std::move(callable_task))));
+			return future;
+		} else {
+			return std::future<ResultType>();
+		}
+	}
+
+	template<typename FunctionType>
+	void execute(int priority, FunctionType&& runnable) {
+		if (thread_command_ == thread_command::run) {
+			enqueue(Task(priority, wrapTask(std::forward<FunctionType>(runnable))));
+		}
+	}
+
+	/**
+	 * @brief Executes all callables of the range, queued with one queue operation.
+	 */
+	template<typename Iterator>
+	void executeAll(Iterator first, Iterator last) {
+		if (thread_command_ != thread_command::run) return;
+		std::vector<Task> tasks;
+		for (; first != last; ++first) tasks.push_back(Task(wrapTask(*first)));
+		enqueueAll(tasks);
+	}
+
+	/**
+	 * @brief Submits all callables of the range, queued with one queue operation, and returns one future of the whole
+	 * batch.
+	 */
+	template<typename Range>
+	Future<typename WhenAllValue<typename BatchResult<Range>::type>::type> submitAll(Range&& range) {
+		typedef typename BatchResult<Range>::Function FunctionType;
+		typedef typename BatchResult<Range>::type ResultType;
+		typedef BatchState<ResultType> State;
+
+		size_t count = static_cast<size_t>(std::distance(std::begin(range), std::end(range)));
+		std::shared_ptr<State> state = std::allocate_shared<State>(SlabStdAllocator<State>(), count);
+		Future<typename WhenAllValue<ResultType>::type> future(state);
+		std::vector<Task> tasks;
+		tasks.reserve(count);
+		size_t index = 0;
+		for (auto& callable : range) {
+			tasks.push_back(Task(wrapTask(BatchTask<ResultType, FunctionType>(state, index++, callable))));
+		}
+		// After shutdown the tasks are dropped with the vector and the batch gets broken_promise
+		if (thread_command_ == thread_command::run) enqueueAll(tasks);
+		return future;
+	}
+
+	template<typename FunctionType>
+	Future<typename std::result_of<FunctionType()>::type> submit(UseFuture, FunctionType&& callable) {
+		typedef typename std::result_of<FunctionType()>::type ResultType;
+
+		Promise<ResultType> promise;
+		Future<ResultType> future = promise.getFuture();
+		execute(PromiseTask<ResultType, typename std::decay<FunctionType>::type>(
+				std::move(promise), std::forward<FunctionType>(callable)));
+		return future;
+	}
+
+	template<typename FunctionType>
+	Future<typename std::result_of<FunctionType()>::type> submit(UseFuture, int priority, FunctionType&& callable) {
+		typedef typename std::result_of<FunctionType()>::type ResultType;
+
+		Promise<ResultType> promise;
+		Future<ResultType> future = promise.getFuture();
+		execute(priority, PromiseTask<ResultType, typename std::decay<FunctionType>::type>(
+				std::move(promise), std::forward<FunctionType>(callable)));
+		return future;
+	}
+
+	template<typename FunctionType>
+	Future<typename std::result_of<FunctionType()>::type> async(FunctionType&& callable) {
+		return submit(use_future, std::forward<FunctionType>(callable));
+	}
+
+#ifdef CONCURRENT_COROUTINES
+	ScheduleAwaitable<ThreadPoolExecutorTemplate> schedule() {
+		return ScheduleAwaitable<ThreadPoolExecutorTemplate>(*this);
+	}
+#endif
+
 	void shutdown() {
-		thread_command_ = thread_command::shutdown_c;
+		onShutdown();
+		thread_command expected = thread_command::run;
+		if (thread_command_.compare_exchange_strong(expected, thread_command::shutdown_c)) wakeWorkers();
 	}
 
 	void shutdownNow() {
-		thread_command_ = thread_command::shutdown_now;
+		onShutdown();
+		if (thread_command_.exchange(thread_command::shutdown_now) == thread_command::run) wakeWorkers();
 	}
 
 	bool isShutdown() const {
@@ -101,47 +268,399 @@ public:
 	}
 
 	bool awaitTermination(int timeoutMs) {
-		using namespace std::chrono;
-
-		auto start_time = high_resolution_clock::now();
-		for (size_t i = 0; i < threadPool.size(); ++i) {
-			int dif = timeoutMs - static_cast<int>(duration_cast<milliseconds>(high_resolution_clock::now() - start_time).count());
-			if (dif < 0) return false;
-			// TODO add wait with timeout
-			threadPool[i]->join();
-//			if (!threadPool[i]->waitFinish(dif)) return false;
+		{
+			std::unique_lock<std::mutex> lock(termination_mutex);
+			bool isTerminated = termination_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+				return live_workers == 0;
+			});
+			if (!isTerminated) return false;
 		}
+		joinPool();
 		return true;
 	}
 
+	/**
+	 * @brief Returns the current number of workers.
+	 */
+	size_t getPoolSize() const {
+		return pool_size;
+	}
+
+	/**
+	 * @brief Returns counters, queue depth, worker times and histograms collected by Stats_. With NoExecutorStats all
+	 * values are zero.
+	 */
+	ExecutorStatsSnapshot snapshot() const {
+		return stats.snapshot();
+	}
+
+	/**
+	 * @brief Returns enqueue, dequeue, start and finish times of the last tasks of every worker recorded by Tracer_.
+	 * With NoExecutorTracer the result is empty.
+	 */
+	std::vector<TraceEvent> traceEvents() const {
+		return tracer.events();
+	}
+
+	/**
+	 * @brief Writes events of Tracer_ in Chrome trace-event JSON, see ExecutorTracer::writeChromeTrace.
+	 */
+	void writeTrace(std::ostream& out) const {
+		tracer.writeChromeTrace(out);
+	}
+
+	/**
+	 * @brief Sets handler of tasks rejected because the task queue is full, it replaces rejection policy. Should be
+	 * called before tasks are submitted.
+	 */
+	void setRejectionHandler(RejectionHandler handler) {
+		rejection_handler = std::move(handler);
+	}
+
 protected:
 	std::atomic<thread_command> thread_command_;
+	Stats_ stats;
+	Tracer_ tracer;
 	Dequeue_ taskQueue;
 	std::vector<Thread_*> threadPool;
 
+	std::mutex termination_mutex;
+	std::condition_variable termination_cond;
+	size_t live_workers;
+	std::once_flag join_flag;
+
+	const size_t core_pool_size;
+	const size_t maximum_pool_size;
+	const int keep_alive_ms;
+	std::function<void(Thread_*)> on_before_start;
+	/// Called by every worker in its own thread before it allocates anything, may be empty
+	const std::function<void()> on_thread_start;
+	const RejectionPolicy rejection_policy;
+	RejectionHandler rejection_handler;
+	/// Guards threadPool and retired
+	std::mutex pool_mutex;
+	std::atomic<size_t> pool_size;
+	/// Tasks queued and not taken yet, counted only by elastic pools. Goes below zero while a worker takes a task
+	/// before its submitter counts it.
+	std::atomic<std::ptrdiff_t> backlog;
+	std::vector<Thread_*> retired;
+
+	Thread_* manager;
+	std::mutex manager_mutex;
+	std::condition_variable manager_cond;
+	bool is_manager_wanted;
+	bool is_manager_stopped;
+	std::atomic_bool is_spawn_requested;
+
+	template<typename Function>
+	ThreadPoolExecutorTemplate(size_t corePoolSize, Function&& onBeforeStart)
+			: ThreadPoolExecutorTemplate(corePoolSize, corePoolSize, 0, std::forward<Function>(onBeforeStart)) { }
+
+	/**
+	 * @brief Constructor of elastic pool. Workers above corePoolSize are started by the manager thread when queued tasks
+	 * outnumber workers, and stop after keepAliveMs without tasks. onBeforeStart is called for every new worker.
+	 */
+	template<typename Function>
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, Function&& onBeforeStart)
+			: ThreadPoolExecutorTemplate(corePoolSize, maximumPoolSize, keepAliveMs, std::forward<Function>(onBeforeStart),
+			                             std::function<void()>()) { }
+
+	/**
+	 * @brief Constructor of elastic pool with onThreadStart, which every worker calls in its own thread before the
+	 * worker loop touches any memory, e.g. to pin the thread so its stack and allocations stay on its NUMA node.
+	 */
 	template<typename Function>
-	ThreadPoolExecutorTemplate(size_t corePoolSize, Function&& onBeforeStart) : thread_command_(thread_command::run) {
-		makePool(corePoolSize, std::forward<Function>(onBeforeStart));
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, Function&& onBeforeStart,
+	                           std::function<void()> onThreadStart)
+			: thread_command_(thread_command::run), live_workers(0), core_pool_size(corePoolSize),
+			  maximum_pool_size(maximumPoolSize < corePoolSize ? corePoolSize : maximumPoolSize),
+			  keep_alive_ms(checkKeepAlive(keepAliveMs)), on_thread_start(std::move(onThreadStart)),
+			  rejection_policy(RejectionPolicy::discard), pool_size(0), backlog(0), manager(nullptr), is_manager_wanted(false),
+			  is_manager_stopped(false), is_spawn_requested(false) {
+		start(std::forward<Function>(onBeforeStart));
+	}
+
+	/**
+	 * @brief Constructor of elastic pool with task queue of queueCapacity tasks. Default constructed queue is used by
+	 * the other constructors, so Dequeue_ needs constructor from capacity only if this one is used.
+	 */
+	template<typename Function>
+	ThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, size_t queueCapacity,
+	                           RejectionPolicy rejectionPolicy, Function&& onBeforeStart)
+			: thread_command_(thread_command::run), taskQueue(queueCapacity), live_workers(0), core_pool_size(corePoolSize),
+			  maximum_pool_size(maximumPoolSize < corePoolSize ? corePoolSize : maximumPoolSize),
+			  keep_alive_ms(checkKeepAlive(keepAliveMs)), rejection_policy(rejectionPolicy), pool_size(0), backlog(0), manager(nullptr), is_manager_wanted(false),
+			  is_manager_stopped(false), is_spawn_requested(false) {
+		start(std::forward<Function>(onBeforeStart));
+	}
+
+	/**
+	 * @throw std::invalid_argument if keepAliveMs is negative, pollStatus would wait forever and extra workers would
+	 * never retire
+	 */
+	static int checkKeepAlive(int keepAliveMs) {
+		if (keepAliveMs < 0) throw std::invalid_argument("ThreadPoolExecutor: keepAliveMs must not be negative");
+		return keepAliveMs;
+	}
+
+	void start(std::function<void(Thread_*)>&& onBeforeStart) {
+		makePool(core_pool_size, std::move(onBeforeStart));
+		if (maximum_pool_size > core_pool_size) manager = new Thread_([this]() { manage(); });
 	}
 
 	void makePool(size_t corePoolSize, std::function<void(Thread_*)>&& onBeforeStart = [](Thread_*){}) {
-		for (size_t i = 0; i < corePoolSize; ++i) {
-			auto* thread = new Thread_([&, i](){
-				do {
-					auto runnable = taskQueue.poll(100);
-					if (runnable) {
-						runnable();
+		on_before_start = std::move(onBeforeStart);
+		for (size_t i = 0; i < corePoolSize; ++i) addWorker(false);
+	}
+
+	/**
+	 * @brief Starts new worker. Extra workers are started only while the executor runs and the pool is not full.
+	 *
+	 * @return true if the worker was started
+	 */
+	bool addWorker(bool isExtra) {
+		std::shared_ptr<Thread_*> self = isExtra ? std::make_shared<Thread_*>(nullptr) : nullptr;
+		std::lock_guard<std::mutex> lock(pool_mutex);
+		if (isExtra && (thread_command_ != thread_command::run || threadPool.size() >= maximum_pool_size)) return false;
+		{
+			std::lock_guard<std::mutex> termination_lock(termination_mutex);
+			++live_workers;
+		}
+		auto* thread = new Thread_([this, self]() {
+			if (on_thread_start) on_thread_start();
+			work(self.get());
+		});
+		if (self) *self = thread;
+		threadPool.push_back(thread);
+		pool_size = threadPool.size();
+		on_before_start(thread);
+		return true;
+	}
+
+	/**
+	 * @brief Worker loop. Extra workers have self set, they wait for tasks at most keep_alive_ms and then retire.
+	 */
+	void work(Thread_* const* self) {
+		typename Stats_::WorkerScope worker(stats);
+		typename Tracer_::WorkerScope tracing(tracer);
+		for (;;) {
+			worker.beginIdle();
+			Task runnable;
+			DequeueStatus status = self ? taskQueue.pollStatus(runnable, keep_alive_ms) : taskQueue.takeStatus(runnable);
+			// Shutdown closes the queue, workers leave when it is drained
+			if (status == DequeueStatus::closed) break;
+			if (status == DequeueStatus::timeout) {
+				if (retire(self)) return;
+				continue;
+			}
+			taskTaken();
+			tracing.taskDequeued();
+			worker.beginBusy();
+			runnable();
+		}
+		std::lock_guard<std::mutex> lock(termination_mutex);
+		if (--live_workers == 0) termination_cond.notify_all();
+	}
+
+	/**
+	 * @brief Removes idle extra worker from the pool, the manager joins it later. Workers are not removed after
+	 * shutdown, they are joined by joinPool. self is read under pool_mutex, addWorker holds it until self is set.
+	 */
+	bool retire(Thread_* const* self) {
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			if (thread_command_ != thread_command::run) return false;
+			Thread_* thread = *self;
+			for (size_t i = 0; i < threadPool.size(); ++i) {
+				if (threadPool[i] != thread) continue;
+				threadPool.erase(threadPool.begin() + static_cast<std::ptrdiff_t>(i));
+				break;
+			}
+			pool_size = threadPool.size();
+			retired.push_back(thread);
+		}
+		{
+			std::lock_guard<std::mutex> lock(termination_mutex);
+			--live_workers;
+		}
+		wakeManager();
+		return true;
+	}
+
+	/**
+	 * @brief Wraps the callable into the task with instrumentation of Stats_ and Tracer_.
+	 */
+	template<typename FunctionType>
+	FunctionWrapper wrapTask(FunctionType&& callable) {
+		return FunctionWrapper(tracer.wrap(stats.wrap(std::forward<FunctionType>(callable))));
+	}
+
+	/**
+	 * @brief Queues the task, applies the rejection handler or policy if the queue is full.
+	 */
+	void enqueue(Task&& task) {
+		stats.taskQueued();
+		// Blocking put fails only when shutdown has closed the queue, the task is rejected then
+		bool isQueued = rejection_policy == RejectionPolicy::block && !rejection_handler ? taskQueue.put(std::move(task))
+		                                                                                 : taskQueue.offer(std::move(task));
+		if (!isQueued) {
+			reject(std::move(task));
+			return;
+		}
+		onTaskQueued();
+	}
+
+	/**
+	 * @brief Queues all tasks with one queue operation, which wakes at most as many idle workers as there are tasks.
+	 * Tasks which do not fit into the queue are rejected one by one.
+	 */
+	void enqueueAll(std::vector<Task>& tasks) {
+		for (size_t i = 0; i < tasks.size(); ++i) stats.taskQueued();
+		size_t count = rejection_policy == RejectionPolicy::block && !rejection_handler
+				? taskQueue.putAll(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()))
+				: taskQueue.offerAll(std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+		for (size_t i = count; i < tasks.size(); ++i) reject(std::move(tasks[i]));
+		if (count == 0) return;
+		onTaskQueued(count);
+	}
+
+	void reject(Task&& task) {
+		stats.taskRejected();
+		if (rejection_handler) {
+			rejection_handler(std::move(task));
+			return;
+		}
+		switch (rejection_policy) {
+			case RejectionPolicy::block:
+			case RejectionPolicy::discard:
+				break;
+			case RejectionPolicy::caller_runs:
+				task();
+				break;
+			case RejectionPolicy::discard_oldest:
+				// After shutdown the queue is closed, queued tasks are kept and the task is dropped
+				while (!taskQueue.isClosed()) {
+					if (taskQueue.poll(0)) taskTaken();
+					if (taskQueue.offer(std::move(task))) {
+						onTaskQueued();
+						break;
 					}
-				} while (!thread_command_ || taskQueue.size() != 0);
-			});
-			threadPool.push_back(thread);
-			onBeforeStart(thread);
+				}
+				break;
+			case RejectionPolicy::abort:
+				throw RejectedExecutionException();
+		}
+	}
+
+	/**
+	 * @brief Called after count tasks are queued. Asks the manager for extra worker if queued tasks outnumber workers.
+	 * The backlog is an atomic counter, so submit does not lock the queue a second time.
+	 */
+	void onTaskQueued(size_t count = 1) {
+		if (maximum_pool_size == core_pool_size) return;
+		std::ptrdiff_t queued = backlog.fetch_add(static_cast<std::ptrdiff_t>(count), std::memory_order_relaxed)
+		                        + static_cast<std::ptrdiff_t>(count);
+		if (is_spawn_requested) return;
+		size_t workers = pool_size;
+		if (workers >= maximum_pool_size || queued <= static_cast<std::ptrdiff_t>(workers)) return;
+		if (!is_spawn_requested.exchange(true)) wakeManager();
+	}
+
+	/**
+	 * @brief Called after a task is taken from the queue.
+	 */
+	void taskTaken() {
+		if (maximum_pool_size != core_pool_size) backlog.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void wakeManager() {
+		std::lock_guard<std::mutex> lock(manager_mutex);
+		is_manager_wanted = true;
+		manager_cond.notify_one();
+	}
+
+	/**
+	 * @brief Manager loop: joins retired workers and starts extra workers while the queue backs up, so thread creation
+	 * and destruction do not happen in submit or in workers.
+	 */
+	void manage() {
+		std::unique_lock<std::mutex> lock(manager_mutex);
+		for (;;) {
+			manager_cond.wait(lock, [this]() { return is_manager_wanted || is_manager_stopped; });
+			if (is_manager_stopped) break;
+			is_manager_wanted = false;
+			lock.unlock();
+
+			joinRetired();
+			is_spawn_requested = false;
+			while (backlog.load(std::memory_order_relaxed) > static_cast<std::ptrdiff_t>(pool_size.load())
+			       && addWorker(true)) { }
+
+			lock.lock();
+		}
+	}
+
+	void stopManager() {
+		if (!manager) return;
+		{
+			std::lock_guard<std::mutex> lock(manager_mutex);
+			is_manager_stopped = true;
 		}
+		manager_cond.notify_one();
+		manager->join();
+		delete manager;
+		manager = nullptr;
+	}
+
+	void joinRetired() {
+		std::vector<Thread_*> threads;
+		{
+			std::lock_guard<std::mutex> lock(pool_mutex);
+			threads.swap(retired);
+		}
+		for (Thread_* thread : threads) {
+			thread->join();
+			delete thread;
+		}
+	}
+
+	/**
+	 * @brief Called by shutdown and shutdownNow before the queue is closed, also when they are called through a
+	 * reference to this class. Derived executors override it to stop their own sources of tasks. It may be called
+	 * more than once.
+	 */
+	virtual void onShutdown() { }
+
+	/**
+	 * @brief Closes the task queue. Idle workers wake up at once, busy workers finish the queued tasks and leave when
+	 * the queue is drained. Closing does not wait for space in a bounded queue, so it is safe to call from a worker.
+	 */
+	void wakeWorkers() {
+		taskQueue.close();
+	}
+
+	/**
+	 * @brief Joins workers once. The pool does not change after shutdown, so threads are joined outside of pool_mutex.
+	 */
+	void joinPool() {
+		std::call_once(join_flag, [this]() {
+			std::vector<Thread_*> threads;
+			{
+				std::lock_guard<std::mutex> lock(pool_mutex);
+				threads = threadPool;
+			}
+			for (Thread_* thread : threads) thread->join();
+		});
 	}
 };
 
 typedef ThreadPoolExecutorTemplate<> ThreadPoolExecutor;
 
+typedef ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper, SlabDeque>, ExecutorStats> InstrumentedThreadPoolExecutor;
+
+typedef ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper, SlabDeque>, NoExecutorStats, ExecutorTracer<>>
+		TracedThreadPoolExecutor;
+
 #ifdef DOXYGEN
 /**
  * @brief Thread pools address two different problems: they usually provide improved performance when executing large
@@ -152,6 +671,27 @@ class ThreadPoolExecutor {
 public:
 	explicit ThreadPoolExecutor(size_t corePoolSize);
 
+	/**
+	 * @brief Creates elastic pool. It keeps corePoolSize workers and starts up to maximumPoolSize - corePoolSize extra
+	 * workers when queued tasks outnumber workers. Extra workers stop after keepAliveMs without tasks. Threads are
+	 * started and joined by a separate manager thread, submit only wakes it up.
+	 *
+	 * @throw std::invalid_argument if keepAliveMs is negative
+	 */
+	ThreadPoolExecutor(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs);
+
+	/**
+	 * @brief Creates pool with task queue of queueCapacity tasks. When the queue is full, execute and submit apply
+	 * rejectionPolicy. Other constructors use unbounded queue and RejectionPolicy::discard.
+	 */
+	ThreadPoolExecutor(size_t corePoolSize, size_t queueCapacity, RejectionPolicy rejectionPolicy);
+
+	/**
+	 * @brief Creates elastic pool with bounded task queue.
+	 */
+	ThreadPoolExecutor(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, size_t queueCapacity,
+	                   RejectionPolicy rejectionPolicy);
+
 	virtual ~ThreadPoolExecutor();
 
 	/**
@@ -177,6 +717,56 @@ public:
 	 */
 	void execute(FunctionType&& runnable);
 
+	/**
+	 * @brief Same as submit(callable), but the task is queued with the given priority. Available when element type of
+	 * the task queue is constructible from priority and FunctionWrapper, e.g. for PriorityThreadPoolExecutor.
+	 */
+	std::future<R> submit(int priority, FunctionType&& callable);
+
+	/**
+	 * @brief Same as execute(runnable), but the task is queued with the given priority. Available when element type of
+	 * the task queue is constructible from priority and FunctionWrapper, e.g. for PriorityThreadPoolExecutor.
+	 */
+	void execute(int priority, FunctionType&& runnable);
+
+	/**
+	 * @brief Same as submit(callable), but returns Future instead of std::future: its shared state is one cache line
+	 * with an atomic state word, waiting sleeps on the word with Futex. Call as submit(use_future, callable).
+	 */
+	Future<R> submit(UseFuture, FunctionType&& callable);
+
+	/**
+	 * @brief Same as submit(priority, callable), but returns Future.
+	 */
+	Future<R> submit(UseFuture, int priority, FunctionType&& callable);
+
+	/**
+	 * @brief Executes all callables of the range [first, last). The tasks are built first and then queued with one
+	 * queue operation, which takes the queue lock once per free space window and wakes only as many idle workers as
+	 * there are tasks. Tasks which do not fit into a bounded queue get the rejection policy one by one.
+	 */
+	void executeAll(Iterator first, Iterator last);
+
+	/**
+	 * @brief Submits all callables of the range like executeAll and returns one future for the whole batch instead of
+	 * a future per task. The future gets the results in the order of the range, or nothing if R is void, when all tasks
+	 * are finished; if some task throws or is dropped, the future gets the first exception after all tasks are
+	 * finished. R must be default constructible and move assignable.
+	 */
+	Future<std::vector<R>> submitAll(Range&& range);
+
+	/**
+	 * @brief Same as submit(use_future, callable). Future supports continuations with then(), whenAll and whenAny. If
+	 * the task is not run because of shutdown or rejection, the future gets std::future_error with broken_promise.
+	 */
+	Future<R> async(FunctionType&& callable);
+
+	/**
+	 * @brief Returns awaitable, co_await of which resumes the coroutine on a worker of this executor. Available with
+	 * CONCURRENT_COROUTINES.
+	 */
+	ScheduleAwaitable<ThreadPoolExecutorTemplate> schedule();
+
 	/**
 	 * @brief Initiates an orderly shutdown in which previously submitted tasks are executed, but no new tasks will be
 	 * accepted. Invocation has no additional effect if already shut down. This method does not wait for previously
@@ -184,11 +774,54 @@ public:
 	 */
 	void shutdown();
 
+	/**
+	 * @brief Initiates shutdown like shutdown does. Idle workers are woken up at once, tasks queued before the call are
+	 * still executed.
+	 */
 	void shutdownNow();
 
 	bool isShutdown() const;
 
+	/**
+	 * @brief Blocks until all workers have finished after a shutdown request, or the timeout occurs, whichever happens
+	 * first.
+	 *
+	 * @param timeoutMs the maximum time to wait, in milliseconds
+	 * @return true if this executor terminated and false if the timeout elapsed before termination
+	 */
 	bool awaitTermination(int timeoutMs);
+
+	/**
+	 * @brief Returns the current number of workers.
+	 */
+	size_t getPoolSize() const;
+
+	/**
+	 * @brief Returns statistics of the executor: submitted, completed and rejected tasks, current queue depth and its
+	 * high-water mark, busy and idle time of every worker, histograms of queue wait and run time of tasks. Available
+	 * when Stats_ is ExecutorStats, e.g. for InstrumentedThreadPoolExecutor; otherwise all values are zero.
+	 */
+	ExecutorStatsSnapshot snapshot() const;
+
+	/**
+	 * @brief Returns enqueue, dequeue, start and finish times of the last tasks of every worker. Available when Tracer_
+	 * is ExecutorTracer, e.g. for TracedThreadPoolExecutor; otherwise the result is empty. Every worker keeps its
+	 * events in its own lock-free ring, so tracing costs two clock reads on submit path and two in the worker.
+	 */
+	std::vector<TraceEvent> traceEvents() const;
+
+	/**
+	 * @brief Writes the trace events in Chrome trace-event JSON, which chrome://tracing and ui.perfetto.dev open: a track
+	 * per worker with the runs of tasks and async events of queue waits, so queueing delay is seen per worker.
+	 */
+	void writeTrace(std::ostream& out) const;
+
+	/**
+	 * @brief Sets handler of tasks rejected because the task queue is full, it replaces rejection policy. The handler
+	 * gets the rejected task and may run, store or drop it; a dropped task of submit breaks its future. Should be called
+	 * before tasks are submitted.
+	 */
+	void setRejectionHandler(RejectionHandler handler);
 };
 #endif //DOXYGEN
 
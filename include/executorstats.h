@@ -0,0 +1,419 @@
+#ifndef EXECUTORSTATS_H
+#define EXECUTORSTATS_H
+
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Snapshot of LogHistogram. Bucket i counts values from bucketLowerBound(i) to bucketUpperBound(i).
+ */
+struct LogHistogramSnapshot {
+	std::vector<uint64_t> counts;
+	uint64_t count;
+
+	LogHistogramSnapshot() : count(0) { }
+
+	static uint64_t bucketLowerBound(size_t bucket);
+
+	static uint64_t bucketUpperBound(size_t bucket);
+
+	/**
+	 * @brief Returns upper bound of the bucket which holds the q-quantile, q is in range [0, 1]. Relative error is
+	 * at most 25%.
+	 */
+	uint64_t percentile(double q) const {
+		if (count == 0) return 0;
+		uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count));
+		if (rank >= count) rank = count - 1;
+		uint64_t seen = 0;
+		for (size_t i = 0; i < counts.size(); ++i) {
+			seen += counts[i];
+			if (seen > rank) return bucketUpperBound(i);
+		}
+		return bucketUpperBound(counts.size() - 1);
+	}
+};
+
+/**
+ * @brief Histogram with logarithmic buckets in HDR style: every power of two range is split into SUB_BUCKETS linear
+ * buckets, so relative error is constant and 64-bit values need only BUCKETS counters.
+ */
+class LogHistogram {
+public:
+	static const unsigned SUB_BITS = 2;
+	static const unsigned SUB_BUCKETS = 1u << SUB_BITS;
+	static const size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+	LogHistogram() {
+		for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+	}
+
+	static size_t bucketOf(uint64_t v) {
+		if (v < SUB_BUCKETS) return static_cast<size_t>(v);
+		unsigned msb = log2Floor(v);
+		return (msb - SUB_BITS + 1) * SUB_BUCKETS + static_cast<size_t>((v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+	}
+
+	void record(uint64_t v) {
+		buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Adds counters of this histogram to the snapshot.
+	 */
+	void addTo(LogHistogramSnapshot& snapshot) const {
+		snapshot.counts.resize(BUCKETS, 0);
+		for (size_t i = 0; i < BUCKETS; ++i) {
+			uint64_t c = buckets[i].load(std::memory_order_relaxed);
+			snapshot.counts[i] += c;
+			snapshot.count += c;
+		}
+	}
+
+	static unsigned log2Floor(uint64_t v) {
+#if defined(__GNUC__)
+		return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+		unsigned r = 0;
+		while (v >>= 1) ++r;
+		return r;
+#endif
+	}
+
+private:
+	std::atomic<uint64_t> buckets[BUCKETS];
+};
+
+inline uint64_t LogHistogramSnapshot::bucketLowerBound(size_t bucket) {
+	if (bucket < LogHistogram::SUB_BUCKETS) return bucket;
+	unsigned msb = static_cast<unsigned>(bucket / LogHistogram::SUB_BUCKETS) + LogHistogram::SUB_BITS - 1;
+	uint64_t sub = bucket % LogHistogram::SUB_BUCKETS;
+	return (LogHistogram::SUB_BUCKETS + sub) << (msb - LogHistogram::SUB_BITS);
+}
+
+inline uint64_t LogHistogramSnapshot::bucketUpperBound(size_t bucket) {
+	if (bucket < LogHistogram::SUB_BUCKETS) return bucket;
+	unsigned msb = static_cast<unsigned>(bucket / LogHistogram::SUB_BUCKETS) + LogHistogram::SUB_BITS - 1;
+	return bucketLowerBound(bucket) + (uint64_t(1) << (msb - LogHistogram::SUB_BITS)) - 1;
+}
+
+/**
+ * @brief Counter split into Stripes_ cache line sized cells. Every thread increments its own cell, the value is summed
+ * on read.
+ */
+template <size_t Stripes_ = 16>
+class StripedCounter {
+public:
+	StripedCounter() {
+		for (auto& cell : cells) cell.value.store(0, std::memory_order_relaxed);
+	}
+
+	void increment() {
+		cells[stripe()].value.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t load() const {
+		uint64_t sum = 0;
+		for (auto& cell : cells) sum += cell.value.load(std::memory_order_relaxed);
+		return sum;
+	}
+
+private:
+	struct Cell {
+		std::atomic<uint64_t> value;
+		char pad[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+	};
+
+	static size_t stripe() {
+		static std::atomic<size_t> next(0);
+		static thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % Stripes_;
+		return index;
+	}
+
+	Cell cells[Stripes_];
+};
+
+struct WorkerStatsSnapshot {
+	uint64_t busyNs;
+	uint64_t idleNs;
+	uint64_t tasks;
+};
+
+/**
+ * @brief Values of ExecutorStats at some moment. Counters of different threads are read one by one, so they are not
+ * an atomic cut, e.g. completed may be ahead of submitted while tasks are running.
+ */
+struct ExecutorStatsSnapshot {
+	uint64_t submitted;
+	uint64_t completed;
+	uint64_t rejected;
+	int64_t queueDepth;
+	int64_t queueHighWater;
+	/// Workers which ever ran in the pool, slots of retired workers are reused by new ones
+	std::vector<WorkerStatsSnapshot> workers;
+	LogHistogramSnapshot queueWaitNs;
+	LogHistogramSnapshot runTimeNs;
+
+	ExecutorStatsSnapshot() : submitted(0), completed(0), rejected(0), queueDepth(0), queueHighWater(0) { }
+};
+
+/**
+ * @brief Stats_ of ThreadPoolExecutorTemplate which records nothing. All hooks are empty and compile to nothing.
+ */
+struct NoExecutorStats {
+	static const bool ENABLED = false;
+
+	class WorkerScope {
+	public:
+		explicit WorkerScope(NoExecutorStats&) { }
+		void beginIdle() { }
+		void beginBusy() { }
+	};
+
+	template<typename F>
+	F&& wrap(F&& f) { return std::forward<F>(f); }
+
+	void taskQueued() { }
+	void taskRejected() { }
+
+	ExecutorStatsSnapshot snapshot() const { return ExecutorStatsSnapshot(); }
+};
+
+/**
+ * @brief Stats_ of ThreadPoolExecutorTemplate which records task counters, queue depth, busy and idle time of workers
+ * and histograms of queue wait and run time.
+ *
+ * Submit path increments a striped counter and stamps the task with the current time. Workers write only their own
+ * padded slot: busy and idle time, completed tasks and histograms, and count taken tasks in another striped counter.
+ * Everything is aggregated by snapshot(). Queue depth is derived on read as submitted minus dequeued tasks. Its high
+ * water mark is sampled by every worker once per SAMPLE_PERIOD tasks and by snapshot(), so short peaks between
+ * samples may be missed.
+ */
+class ExecutorStats {
+	/**
+	 * @brief Counters of one worker. Padding keeps neighbour slots on different cache lines.
+	 */
+	struct WorkerSlot {
+		explicit WorkerSlot(const ExecutorStats* owner)
+				: owner(owner), busy_ns(0), idle_ns(0), tasks(0), queue_high_water(0) { }
+
+		char pad_front[CACHE_LINE_SIZE];
+		const ExecutorStats* owner;
+		std::atomic<uint64_t> busy_ns;
+		std::atomic<uint64_t> idle_ns;
+		std::atomic<uint64_t> tasks;
+		/// Highest queue depth sampled by the worker, written by the worker only
+		std::atomic<int64_t> queue_high_water;
+		LogHistogram queue_wait_ns;
+		LogHistogram run_time_ns;
+	};
+
+public:
+	static const bool ENABLED = true;
+	/// Every worker samples the queue depth once per SAMPLE_PERIOD tasks
+	static const uint64_t SAMPLE_PERIOD = 64;
+
+	ExecutorStats() : snapshot_high_water(0), external(this) { }
+
+	ExecutorStats(const ExecutorStats&) = delete;
+	ExecutorStats& operator=(const ExecutorStats&) = delete;
+
+	static int64_t nowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	 * @brief Registers the calling thread as a worker for its lifetime and accounts its busy and idle time.
+	 */
+	class WorkerScope {
+	public:
+		explicit WorkerScope(ExecutorStats& stats) : stats(stats), slot(stats.acquireSlot()), since(nowNs()), is_busy(false) {
+			currentSlot() = slot;
+		}
+
+		~WorkerScope() {
+			account(nowNs());
+			currentSlot() = nullptr;
+			stats.releaseSlot(slot);
+		}
+
+		void beginIdle() {
+			if (!is_busy) return;
+			account(nowNs());
+			is_busy = false;
+		}
+
+		void beginBusy() {
+			account(nowNs());
+			is_busy = true;
+		}
+
+	private:
+		void account(int64_t now) {
+			(is_busy ? slot->busy_ns : slot->idle_ns).fetch_add(static_cast<uint64_t>(now - since), std::memory_order_relaxed);
+			since = now;
+		}
+
+		ExecutorStats& stats;
+		WorkerSlot* slot;
+		int64_t since;
+		bool is_busy;
+	};
+
+	/**
+	 * @brief Callable which records queue wait and run time of F. Task which is destroyed without run is counted as
+	 * removed from the queue.
+	 */
+	template<typename F>
+	class TimedTask {
+	public:
+		TimedTask(F&& f, ExecutorStats* stats) : f(std::move(f)), stats(stats), queued_ns(nowNs()), is_queued(true) { }
+		TimedTask(const F& f, ExecutorStats* stats) : f(f), stats(stats), queued_ns(nowNs()), is_queued(true) { }
+
+		TimedTask(TimedTask&& other) noexcept(std::is_nothrow_move_constructible<F>::value)
+				: f(std::move(other.f)), stats(other.stats), queued_ns(other.queued_ns), is_queued(other.is_queued) {
+			other.is_queued = false;
+		}
+
+		TimedTask(const TimedTask&) = delete;
+		TimedTask& operator=(const TimedTask&) = delete;
+
+		~TimedTask() {
+			dequeued();
+		}
+
+		void operator()() {
+			int64_t start = nowNs();
+			WorkerSlot* slot = currentSlot();
+			if (slot && slot->owner == stats) stats->sampleQueueDepth(*slot);
+			else slot = &stats->external;
+			dequeued();
+			slot->queue_wait_ns.record(static_cast<uint64_t>(start - queued_ns));
+			f();
+			slot->run_time_ns.record(static_cast<uint64_t>(nowNs() - start));
+			slot->tasks.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		void dequeued() {
+			if (!is_queued) return;
+			stats->dequeued.increment();
+			is_queued = false;
+		}
+
+		F f;
+		ExecutorStats* stats;
+		int64_t queued_ns;
+		bool is_queued;
+	};
+
+	template<typename F>
+	TimedTask<typename std::decay<F>::type> wrap(F&& f) {
+		return TimedTask<typename std::decay<F>::type>(std::forward<F>(f), this);
+	}
+
+	/**
+	 * @brief Called before the task is offered to the queue.
+	 */
+	void taskQueued() {
+		submitted.increment();
+	}
+
+	void taskRejected() {
+		rejected.increment();
+	}
+
+	ExecutorStatsSnapshot snapshot() const {
+		ExecutorStatsSnapshot s;
+		s.submitted = submitted.load();
+		s.rejected = rejected.load();
+		s.queueDepth = queueDepth();
+		int64_t highWater = snapshot_high_water.load(std::memory_order_relaxed);
+		while (s.queueDepth > highWater && !snapshot_high_water.compare_exchange_weak(highWater, s.queueDepth)) { }
+		s.queueHighWater = highWater > s.queueDepth ? highWater : s.queueDepth;
+		addSlot(s, external, false);
+		std::lock_guard<std::mutex> lock(slots_mutex);
+		for (const WorkerSlot& slot : slots) {
+			addSlot(s, slot, true);
+			int64_t slotHighWater = slot.queue_high_water.load(std::memory_order_relaxed);
+			if (slotHighWater > s.queueHighWater) s.queueHighWater = slotHighWater;
+		}
+		return s;
+	}
+
+private:
+	/**
+	 * @brief Returns submitted minus dequeued tasks. Dequeued tasks are read first, so the result is not below zero for
+	 * tasks which were counted by taskQueued.
+	 */
+	int64_t queueDepth() const {
+		uint64_t out = dequeued.load();
+		return static_cast<int64_t>(submitted.load()) - static_cast<int64_t>(out);
+	}
+
+	/**
+	 * @brief Called by the worker before the task is counted as dequeued, so the sample includes the task.
+	 */
+	void sampleQueueDepth(WorkerSlot& slot) const {
+		if (slot.tasks.load(std::memory_order_relaxed) % SAMPLE_PERIOD != 0) return;
+		int64_t depth = queueDepth();
+		if (depth > slot.queue_high_water.load(std::memory_order_relaxed)) {
+			slot.queue_high_water.store(depth, std::memory_order_relaxed);
+		}
+	}
+
+	static WorkerSlot*& currentSlot() {
+		static thread_local WorkerSlot* slot = nullptr;
+		return slot;
+	}
+
+	static void addSlot(ExecutorStatsSnapshot& s, const WorkerSlot& slot, bool isWorker) {
+		uint64_t tasks = slot.tasks.load(std::memory_order_relaxed);
+		s.completed += tasks;
+		slot.queue_wait_ns.addTo(s.queueWaitNs);
+		slot.run_time_ns.addTo(s.runTimeNs);
+		if (isWorker) {
+			s.workers.push_back(WorkerStatsSnapshot{slot.busy_ns.load(std::memory_order_relaxed),
+			                                        slot.idle_ns.load(std::memory_order_relaxed), tasks});
+		}
+	}
+
+	WorkerSlot* acquireSlot() {
+		std::lock_guard<std::mutex> lock(slots_mutex);
+		if (!free_slots.empty()) {
+			WorkerSlot* slot = free_slots.back();
+			free_slots.pop_back();
+			return slot;
+		}
+		slots.emplace_back(this);
+		return &slots.back();
+	}
+
+	void releaseSlot(WorkerSlot* slot) {
+		std::lock_guard<std::mutex> lock(slots_mutex);
+		free_slots.push_back(slot);
+	}
+
+	StripedCounter<> submitted;
+	StripedCounter<> rejected;
+	/// Tasks taken from the queue, run by caller_runs or dropped
+	StripedCounter<> dequeued;
+	/// Highest queue depth seen by snapshot()
+	mutable std::atomic<int64_t> snapshot_high_water;
+	/// Tasks run outside of workers, e.g. by RejectionPolicy::caller_runs
+	WorkerSlot external;
+
+	mutable std::mutex slots_mutex;
+	std::deque<WorkerSlot> slots;
+	std::vector<WorkerSlot*> free_slots;
+};
+
+#endif // EXECUTORSTATS_H
@@ -0,0 +1,301 @@
+#ifndef EXECUTORTRACER_H
+#define EXECUTORTRACER_H
+
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ios>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Timestamps of one task in nanoseconds of steady_clock: when it was queued, taken from the queue by a worker,
+ * started and finished. worker is the index of the worker which ran the task, -1 for tasks run outside of workers,
+ * e.g. by RejectionPolicy::caller_runs.
+ */
+struct TraceEvent {
+	int64_t enqueueNs;
+	int64_t dequeueNs;
+	int64_t startNs;
+	int64_t finishNs;
+	int worker;
+};
+
+/**
+ * @brief Tracer_ of ThreadPoolExecutorTemplate which records nothing. All hooks are empty and compile to nothing.
+ */
+struct NoExecutorTracer {
+	static const bool ENABLED = false;
+
+	class WorkerScope {
+	public:
+		explicit WorkerScope(NoExecutorTracer&) { }
+		void taskDequeued() { }
+	};
+
+	template<typename F>
+	F&& wrap(F&& f) { return std::forward<F>(f); }
+
+	std::vector<TraceEvent> events() const { return std::vector<TraceEvent>(); }
+
+	void writeChromeTrace(std::ostream& out) const {
+		out << "{\"traceEvents\":[]}";
+	}
+};
+
+/**
+ * @brief Tracer_ of ThreadPoolExecutorTemplate which records TraceEvent of every task into a ring buffer of its worker.
+ * The ring keeps the last Capacity_ events, older ones are overwritten.
+ *
+ * Submit path only stamps the task with the current time. The worker writes events into its own ring without locks or
+ * read-modify-write operations, readers copy the ring and drop the events which were overwritten while copying. As in
+ * a seqlock, the worker announces a slot before it writes into it, so readers also drop a slot written concurrently.
+ */
+template <size_t Capacity_ = 4096>
+class ExecutorTracer {
+	static_assert((Capacity_ & (Capacity_ - 1)) == 0, "ExecutorTracer: Capacity_ is not a power of two");
+
+	/**
+	 * @brief Events of one worker. Single writer, any number of readers.
+	 */
+	struct TraceRing {
+		TraceRing(const ExecutorTracer* owner, int worker)
+				: owner(owner), worker(worker), claimed(0), written(0), dequeue_ns(0) { }
+
+		struct Slot {
+			std::atomic<int64_t> enqueue_ns;
+			std::atomic<int64_t> dequeue_ns;
+			std::atomic<int64_t> start_ns;
+			std::atomic<int64_t> finish_ns;
+		};
+
+		void push(int64_t enqueueNs, int64_t dequeueNs, int64_t startNs, int64_t finishNs) {
+			uint64_t index = written.load(std::memory_order_relaxed);
+			Slot& slot = slots[index & (Capacity_ - 1)];
+			// Readers which see any of the stores below also see the claim, see copyTo
+			claimed.store(index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.enqueue_ns.store(enqueueNs, std::memory_order_relaxed);
+			slot.dequeue_ns.store(dequeueNs, std::memory_order_relaxed);
+			slot.start_ns.store(startNs, std::memory_order_relaxed);
+			slot.finish_ns.store(finishNs, std::memory_order_relaxed);
+			written.store(index + 1, std::memory_order_release);
+		}
+
+		void copyTo(std::vector<TraceEvent>& out) const {
+			uint64_t end = written.load(std::memory_order_acquire);
+			uint64_t begin = end > Capacity_ ? end - Capacity_ : 0;
+			size_t first = out.size();
+			for (uint64_t i = begin; i < end; ++i) {
+				const Slot& slot = slots[i & (Capacity_ - 1)];
+				out.push_back(TraceEvent{slot.enqueue_ns.load(std::memory_order_relaxed),
+				                         slot.dequeue_ns.load(std::memory_order_relaxed),
+				                         slot.start_ns.load(std::memory_order_relaxed),
+				                         slot.finish_ns.load(std::memory_order_relaxed), worker});
+			}
+			// Event i is kept only if no write into its slot has started, i.e. claimed <= i + Capacity_
+			std::atomic_thread_fence(std::memory_order_acquire);
+			uint64_t now = claimed.load(std::memory_order_relaxed);
+			uint64_t overwritten = now > Capacity_ + begin ? now - Capacity_ - begin : 0;
+			if (overwritten > end - begin) overwritten = end - begin;
+			out.erase(out.begin() + static_cast<std::ptrdiff_t>(first),
+			          out.begin() + static_cast<std::ptrdiff_t>(first + overwritten));
+		}
+
+		char pad_front[CACHE_LINE_SIZE];
+		const ExecutorTracer* owner;
+		const int worker;
+		/// Number of events whose write has started, ahead of written by one while the worker writes a slot
+		std::atomic<uint64_t> claimed;
+		std::atomic<uint64_t> written;
+		/// Time when the worker took the current task, written and read by the worker only
+		int64_t dequeue_ns;
+		Slot slots[Capacity_];
+	};
+
+public:
+	static const bool ENABLED = true;
+
+	ExecutorTracer() : origin_ns(nowNs()), external(this, -1) { }
+
+	ExecutorTracer(const ExecutorTracer&) = delete;
+	ExecutorTracer& operator=(const ExecutorTracer&) = delete;
+
+	static int64_t nowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	 * @brief Registers the calling thread as a worker for its lifetime, the worker gets its own ring.
+	 */
+	class WorkerScope {
+	public:
+		explicit WorkerScope(ExecutorTracer& tracer) : tracer(tracer), ring(tracer.acquireRing()) {
+			currentRing() = ring;
+		}
+
+		~WorkerScope() {
+			currentRing() = nullptr;
+			tracer.releaseRing(ring);
+		}
+
+		/**
+		 * @brief Called by the worker when it has taken a task from the queue.
+		 */
+		void taskDequeued() {
+			ring->dequeue_ns = nowNs();
+		}
+
+	private:
+		ExecutorTracer& tracer;
+		TraceRing* ring;
+	};
+
+	/**
+	 * @brief Callable which records TraceEvent of F.
+	 */
+	template<typename F>
+	class TracedTask {
+	public:
+		TracedTask(F&& f, ExecutorTracer* tracer) : f(std::move(f)), tracer(tracer), enqueue_ns(nowNs()) { }
+		TracedTask(const F& f, ExecutorTracer* tracer) : f(f), tracer(tracer), enqueue_ns(nowNs()) { }
+
+		TracedTask(TracedTask&& other) = default;
+
+		void operator()() {
+			int64_t start = nowNs();
+			TraceRing* ring = currentRing();
+			if (ring && ring->owner == tracer) {
+				int64_t dequeued = ring->dequeue_ns;
+				f();
+				ring->push(enqueue_ns, dequeued, start, nowNs());
+			} else {
+				f();
+				int64_t finish = nowNs();
+				std::lock_guard<std::mutex> lock(tracer->external_mutex);
+				tracer->external.push(enqueue_ns, start, start, finish);
+			}
+		}
+
+	private:
+		F f;
+		ExecutorTracer* tracer;
+		int64_t enqueue_ns;
+	};
+
+	template<typename F>
+	TracedTask<typename std::decay<F>::type> wrap(F&& f) {
+		return TracedTask<typename std::decay<F>::type>(std::forward<F>(f), this);
+	}
+
+	/**
+	 * @brief Returns events which are kept in the rings, grouped by worker. The event of a task is recorded after the
+	 * task returns, so it may be missing right after its future is ready.
+	 */
+	std::vector<TraceEvent> events() const {
+		std::vector<TraceEvent> result;
+		{
+			std::lock_guard<std::mutex> lock(external_mutex);
+			external.copyTo(result);
+		}
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		for (const TraceRing& ring : rings) ring.copyTo(result);
+		return result;
+	}
+
+	/**
+	 * @brief Writes events in Chrome trace-event JSON, which is opened by chrome://tracing and ui.perfetto.dev. Every
+	 * worker is a thread track with a complete event per task run, queue waits are async events on their own tracks.
+	 * Times are in microseconds since the tracer was created.
+	 */
+	void writeChromeTrace(std::ostream& out) const {
+		std::vector<TraceEvent> all = events();
+		std::ios_base::fmtflags flags = out.flags();
+		std::streamsize precision = out.precision();
+		out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+		bool isFirst = true;
+		std::vector<bool> isNamed;
+		for (size_t i = 0; i < all.size(); ++i) {
+			const TraceEvent& e = all[i];
+			int tid = e.worker + 1;
+			if (static_cast<size_t>(tid) >= isNamed.size()) isNamed.resize(static_cast<size_t>(tid) + 1, false);
+			if (!isNamed[static_cast<size_t>(tid)]) {
+				isNamed[static_cast<size_t>(tid)] = true;
+				separate(out, isFirst);
+				out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":\"";
+				if (e.worker < 0) out << "external";
+				else out << "worker " << e.worker;
+				out << "\"}}";
+			}
+			separate(out, isFirst);
+			out << "{\"ph\":\"X\",\"name\":\"task\",\"cat\":\"run\",\"pid\":1,\"tid\":" << tid
+			    << ",\"ts\":" << micros(e.startNs) << ",\"dur\":" << durationMicros(e.finishNs - e.startNs)
+			    << ",\"args\":{\"queue_wait_us\":" << durationMicros(e.dequeueNs - e.enqueueNs)
+			    << ",\"dispatch_us\":" << durationMicros(e.startNs - e.dequeueNs) << "}}";
+			out << ",{\"ph\":\"b\",\"name\":\"queued\",\"cat\":\"queue\",\"id\":" << i << ",\"pid\":1,\"tid\":" << tid
+			    << ",\"ts\":" << micros(e.enqueueNs) << "}";
+			out << ",{\"ph\":\"e\",\"name\":\"queued\",\"cat\":\"queue\",\"id\":" << i << ",\"pid\":1,\"tid\":" << tid
+			    << ",\"ts\":" << micros(e.dequeueNs) << "}";
+		}
+		out << "]}";
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+private:
+	static TraceRing*& currentRing() {
+		static thread_local TraceRing* ring = nullptr;
+		return ring;
+	}
+
+	static void separate(std::ostream& out, bool& isFirst) {
+		if (!isFirst) out << ',';
+		isFirst = false;
+	}
+
+	/**
+	 * @brief Converts the time point to microseconds since origin_ns.
+	 */
+	double micros(int64_t ns) const {
+		return durationMicros(ns - origin_ns);
+	}
+
+	static double durationMicros(int64_t ns) {
+		return static_cast<double>(ns) / 1000.0;
+	}
+
+	TraceRing* acquireRing() {
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		if (!free_rings.empty()) {
+			TraceRing* ring = free_rings.back();
+			free_rings.pop_back();
+			return ring;
+		}
+		rings.emplace_back(this, static_cast<int>(rings.size()));
+		return &rings.back();
+	}
+
+	void releaseRing(TraceRing* ring) {
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		free_rings.push_back(ring);
+	}
+
+	const int64_t origin_ns;
+	/// Tasks run outside of workers, guarded by external_mutex
+	TraceRing external;
+	mutable std::mutex external_mutex;
+
+	mutable std::mutex rings_mutex;
+	std::deque<TraceRing> rings;
+	std::vector<TraceRing*> free_rings;
+};
+
+#endif // EXECUTORTRACER_H
@@ -0,0 +1,125 @@
+#ifndef FUNCTIONWRAPPER_H
+#define FUNCTIONWRAPPER_H
+
+#include "slaballocator.h"
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Wrapper for custom invoke operator available function types. Callables up to InlineSize_ bytes with
+ * non-throwing move constructor are stored in place, larger ones are allocated with Allocator_, a class with static
+ * allocate(size) and deallocate(p). SlabAllocator suits tasks which are created and destroyed in different threads,
+ * HeapAllocator uses operator new.
+ * @note Source from: "Энтони Уильямс, Параллельное программирование на С++ в действии. Практика разработки многопоточных
+ * программ. Пер. с англ. Слинкин А. А. - M.: ДМК Пресс, 2012 - 672c.: ил." (page 387)
+ */
+template <size_t InlineSize_ = 48, typename Allocator_ = SlabAllocator>
+class FunctionWrapperTemplate {
+	typedef typename std::aligned_storage<InlineSize_, alignof(std::max_align_t)>::type Storage;
+
+	struct VTable {
+		void (*call)(Storage&);
+		void (*move)(Storage& dst, Storage& src);
+		void (*destroy)(Storage&);
+	};
+
+	template<typename F>
+	struct Fits: std::integral_constant<bool, sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage) &&
+	                                          std::is_nothrow_move_constructible<F>::value> {};
+
+	template<typename F, bool = Fits<F>::value>
+	struct Impl {
+		static F* get(Storage& s) { return reinterpret_cast<F*>(&s); }
+		template<typename Type>
+		static void create(Storage& s, Type&& f) { new (&s) F(std::forward<Type>(f)); }
+		static void call(Storage& s) { (*get(s))(); }
+		static void move(Storage& dst, Storage& src) {
+			new (&dst) F(std::move(*get(src)));
+			get(src)->~F();
+		}
+		static void destroy(Storage& s) { get(s)->~F(); }
+	};
+
+	template<typename F>
+	struct Impl<F, false> {
+		static_assert(alignof(F) <= alignof(std::max_align_t), "FunctionWrapper: over-aligned callable");
+
+		static F*& get(Storage& s) { return *reinterpret_cast<F**>(&s); }
+		template<typename Type>
+		static void create(Storage& s, Type&& f) {
+			void* p = Allocator_::allocate(sizeof(F));
+			try {
+				get(s) = new (p) F(std::forward<Type>(f));
+			} catch (...) {
+				Allocator_::deallocate(p);
+				throw;
+			}
+		}
+		static void call(Storage& s) { (*get(s))(); }
+		static void move(Storage& dst, Storage& src) { get(dst) = get(src); }
+		static void destroy(Storage& s) {
+			get(s)->~F();
+			Allocator_::deallocate(get(s));
+		}
+	};
+
+	template<typename F>
+	static const VTable* vtableFor() {
+		static const VTable vtable = { &Impl<F>::call, &Impl<F>::move, &Impl<F>::destroy };
+		return &vtable;
+	}
+
+	Storage storage;
+	const VTable* vtable;
+
+public:
+	/**
+	 * @brief Returns true if callable of type F is stored without heap allocation.
+	 */
+	template<typename F>
+	static constexpr bool isInline() {
+		return Fits<typename std::decay<F>::type>::value;
+	}
+
+	template<typename F, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<F>::type, FunctionWrapperTemplate>::value>::type>
+	explicit FunctionWrapperTemplate(F&& f): vtable(vtableFor<typename std::decay<F>::type>()) {
+		Impl<typename std::decay<F>::type>::create(storage, std::forward<F>(f));
+	}
+
+	void operator()() { vtable->call(storage); }
+
+	explicit operator bool() const noexcept { return vtable != nullptr; }
+
+	FunctionWrapperTemplate() noexcept : vtable(nullptr) {}
+	FunctionWrapperTemplate(FunctionWrapperTemplate&& other) noexcept : vtable(other.vtable) {
+		if (vtable) vtable->move(storage, other.storage);
+		other.vtable = nullptr;
+	}
+	FunctionWrapperTemplate& operator=(FunctionWrapperTemplate&& other) noexcept {
+		if (this != &other) {
+			reset();
+			vtable = other.vtable;
+			if (vtable) vtable->move(storage, other.storage);
+			other.vtable = nullptr;
+		}
+		return *this;
+	}
+
+	~FunctionWrapperTemplate() { reset(); }
+
+	FunctionWrapperTemplate(const FunctionWrapperTemplate& other) = delete;
+	FunctionWrapperTemplate& operator=(const FunctionWrapperTemplate&) = delete;
+
+private:
+	void reset() noexcept {
+		if (vtable) vtable->destroy(storage);
+		vtable = nullptr;
+	}
+};
+
+typedef FunctionWrapperTemplate<> FunctionWrapper;
+
+#endif // FUNCTIONWRAPPER_H
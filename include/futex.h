@@ -0,0 +1,76 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#endif
+
+/**
+ * @brief Waiting on a 32-bit atomic word: wait blocks while the word holds the expected value, wakeAll wakes threads
+ * blocked on the word. On Linux it is the futex system call, which needs no memory besides the word, elsewhere threads
+ * park on mutex and condition variable buckets chosen by address of the word.
+ *
+ * Wakeups may be spurious, callers check their condition in a loop.
+ */
+class Futex {
+public:
+	/**
+	 * @param timeoutNs how long to wait, in nanoseconds, negative to wait without timeout
+	 */
+	static void wait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs = -1) {
+#if defined(__linux__)
+		timespec timeout;
+		timeout.tv_sec = static_cast<time_t>(timeoutNs / 1000000000);
+		timeout.tv_nsec = static_cast<long>(timeoutNs % 1000000000);
+		syscall(SYS_futex, address(word), FUTEX_WAIT_PRIVATE, expected, timeoutNs < 0 ? nullptr : &timeout, nullptr, 0);
+#else
+		Bucket& bucket = bucketOf(word);
+		std::unique_lock<std::mutex> lock(bucket.mutex);
+		if (word.load(std::memory_order_acquire) != expected) return;
+		if (timeoutNs < 0) bucket.cond.wait(lock);
+		else bucket.cond.wait_for(lock, std::chrono::nanoseconds(timeoutNs));
+#endif
+	}
+
+	static void wakeAll(std::atomic<uint32_t>& word) {
+#if defined(__linux__)
+		syscall(SYS_futex, address(word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+		Bucket& bucket = bucketOf(word);
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+		bucket.cond.notify_all();
+#endif
+	}
+
+private:
+#if defined(__linux__)
+	static uint32_t* address(std::atomic<uint32_t>& word) {
+		static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex: atomic word is not 32-bit");
+		return reinterpret_cast<uint32_t*>(&word);
+	}
+#else
+	struct Bucket {
+		std::mutex mutex;
+		std::condition_variable cond;
+	};
+
+	static Bucket& bucketOf(std::atomic<uint32_t>& word) {
+		static Bucket buckets[64];
+		return buckets[std::hash<void*>()(&word) % 64];
+	}
+#endif
+};
+
+#endif // FUTEX_H
@@ -0,0 +1,795 @@
+#ifndef FUTURE_H
+#define FUTURE_H
+
+#include "functionwrapper.h"
+#include "futex.h"
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class Future;
+
+/**
+ * @brief Value stored in shared state of Future<void>.
+ */
+struct VoidValue { };
+
+template <typename T>
+struct FutureValue {
+	typedef T type;
+};
+
+template <>
+struct FutureValue<void> {
+	typedef VoidValue type;
+};
+
+/**
+ * @brief Shared state of Future and Promise. It becomes ready once, with value or exception, and then calls the
+ * continuation in the thread which made it ready. The value is moved out by the single consumer.
+ *
+ * All synchronization goes through one atomic state word: waiters spin shortly and then sleep on the word with Futex,
+ * the continuation is handed over by a flag in the same word. For small values the state with the control block of
+ * std::allocate_shared fits in one cache line.
+ */
+template <typename T>
+class FutureState {
+public:
+	typedef typename FutureValue<T>::type Value;
+
+	static const int SPIN_COUNT = 128;
+
+	FutureState() : state(0), continuation(nullptr) { }
+
+	~FutureState() {
+		if (state.load(std::memory_order_relaxed) & HAS_VALUE) value()->~Value();
+		if (continuation) destroyContinuation(continuation);
+	}
+
+	FutureState(const FutureState&) = delete;
+	FutureState& operator=(const FutureState&) = delete;
+
+	/**
+	 * @throw std::future_error with promise_already_satisfied if the state is ready
+	 */
+	template<typename... Args>
+	void setValue(Args&&... args) {
+		claim();
+		try {
+			new (&storage) Value(std::forward<Args>(args)...);
+		} catch (...) {
+			state.fetch_and(~SETTING, std::memory_order_relaxed);
+			throw;
+		}
+		publish(HAS_VALUE);
+	}
+
+	/**
+	 * @throw std::future_error with promise_already_satisfied if the state is ready
+	 */
+	void setException(std::exception_ptr e) {
+		claim();
+		error = e;
+		publish(0);
+	}
+
+	/**
+	 * @brief Calls f with args and stores its result or exception.
+	 */
+	template<typename F, typename... Args>
+	void setResultOf(F& f, Args&&... args) {
+		try {
+			callAndSet(std::is_void<T>(), f, std::forward<Args>(args)...);
+		} catch (...) {
+			setException(std::current_exception());
+		}
+	}
+
+	bool isReady() const {
+		return (state.load(std::memory_order_acquire) & READY) != 0;
+	}
+
+	void wait() {
+		waitUntil(nullptr);
+	}
+
+	/**
+	 * @return true if the state is ready, false if timeout elapsed
+	 */
+	template<typename Rep, typename Period>
+	bool waitFor(const std::chrono::duration<Rep, Period>& timeout) {
+		Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+		return waitUntil(&deadline);
+	}
+
+	bool waitFor(int timeoutMs) {
+		return waitFor(std::chrono::milliseconds(timeoutMs));
+	}
+
+	/**
+	 * @brief Waits until the state is ready and moves the value out, or rethrows the stored exception.
+	 */
+	Value take() {
+		wait();
+		if (error) std::rethrow_exception(error);
+		return std::move(*value());
+	}
+
+	/**
+	 * @brief Returns stored exception of the ready state or nullptr.
+	 */
+	std::exception_ptr exception() const {
+		return error;
+	}
+
+	/**
+	 * @brief Sets the callback which is called once when the state becomes ready. If the state is already ready, the
+	 * callback is called at once in the calling thread. Only one callback may be set.
+	 */
+	void onReady(FunctionWrapper&& callback) {
+		if (isReady()) {
+			callback();
+			return;
+		}
+		continuation = new (SlabAllocator::allocate(sizeof(FunctionWrapper))) FunctionWrapper(std::move(callback));
+		if (state.fetch_or(CONTINUATION, std::memory_order_acq_rel) & READY) runContinuation();
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Bits of the state word. SETTING is taken by the producer before it writes the value, READY is set after.
+	 * WAITERS means some thread sleeps on the word, CONTINUATION means the continuation is set. Whichever of READY and
+	 * CONTINUATION comes second runs the continuation.
+	 */
+	enum : uint32_t {
+		SETTING = 1,
+		READY = 2,
+		HAS_VALUE = 4,
+		WAITERS = 8,
+		CONTINUATION = 16
+	};
+
+	Value* value() {
+		return reinterpret_cast<Value*>(&storage);
+	}
+
+	void claim() {
+		if (state.fetch_or(SETTING, std::memory_order_acquire) & SETTING) {
+			throw std::future_error(std::future_errc::promise_already_satisfied);
+		}
+	}
+
+	void publish(uint32_t flags) {
+		uint32_t old = state.fetch_or(READY | flags, std::memory_order_acq_rel);
+		if (old & WAITERS) Futex::wakeAll(state);
+		if (old & CONTINUATION) runContinuation();
+	}
+
+	/**
+	 * @brief Runs the continuation in the thread which made the state ready. Continuations handle their own errors, see
+	 * ThenState::schedule; an exception which still escapes is dropped, so it does not fail setValue of this state,
+	 * which is already satisfied.
+	 */
+	void runContinuation() {
+		FunctionWrapper callback(std::move(*continuation));
+		destroyContinuation(continuation);
+		continuation = nullptr;
+		try {
+			callback();
+		} catch (...) {
+		}
+	}
+
+	static void destroyContinuation(FunctionWrapper* callback) {
+		callback->~FunctionWrapper();
+		SlabAllocator::deallocate(callback);
+	}
+
+	bool waitUntil(const Clock::time_point* deadline) {
+		uint32_t s = state.load(std::memory_order_acquire);
+		for (int i = 0; i < SPIN_COUNT && !(s & READY); ++i) {
+			cpuRelax();
+			s = state.load(std::memory_order_acquire);
+		}
+		while (!(s & READY)) {
+			if (!(s & WAITERS) && !state.compare_exchange_weak(s, s | WAITERS, std::memory_order_acquire)) continue;
+			int64_t timeoutNs = -1;
+			if (deadline) {
+				Clock::time_point now = Clock::now();
+				if (now >= *deadline) return false;
+				timeoutNs = std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - now).count();
+			}
+			Futex::wait(state, s | WAITERS, timeoutNs);
+			s = state.load(std::memory_order_acquire);
+		}
+		return true;
+	}
+
+	template<typename F, typename... Args>
+	void callAndSet(std::true_type, F& f, Args&&... args) {
+		f(std::forward<Args>(args)...);
+		setValue();
+	}
+
+	template<typename F, typename... Args>
+	void callAndSet(std::false_type, F& f, Args&&... args) {
+		setValue(f(std::forward<Args>(args)...));
+	}
+
+	std::atomic<uint32_t> state;
+	std::exception_ptr error;
+	FunctionWrapper* continuation;
+	typename std::aligned_storage<sizeof(Value), alignof(Value)>::type storage;
+};
+
+template <typename T>
+const int FutureState<T>::SPIN_COUNT;
+
+/**
+ * @brief Writing side of Future. Destroying a promise which has not been satisfied stores std::future_error with
+ * broken_promise, so waiters and continuations never hang.
+ */
+template <typename T>
+class Promise {
+public:
+	Promise() : state(std::allocate_shared<FutureState<T>>(SlabStdAllocator<FutureState<T>>())) { }
+
+	Promise(Promise&& other) noexcept = default;
+
+	Promise& operator=(Promise&& other) noexcept {
+		if (this != &other) {
+			breakPromise();
+			state = std::move(other.state);
+		}
+		return *this;
+	}
+
+	~Promise() {
+		breakPromise();
+	}
+
+	Future<T> getFuture() {
+		return Future<T>(state);
+	}
+
+	template<typename... Args>
+	void setValue(Args&&... args) {
+		state->setValue(std::forward<Args>(args)...);
+	}
+
+	void setException(std::exception_ptr e) {
+		state->setException(e);
+	}
+
+	/**
+	 * @brief Calls f with args and stores its result or exception.
+	 */
+	template<typename F, typename... Args>
+	void setResultOf(F& f, Args&&... args) {
+		state->setResultOf(f, std::forward<Args>(args)...);
+	}
+
+private:
+	void breakPromise() {
+		if (state && !state->isReady()) {
+			try {
+				state->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+			} catch (const std::future_error&) {
+				// Satisfied concurrently
+			}
+		}
+	}
+
+	std::shared_ptr<FutureState<T>> state;
+};
+
+/**
+ * @brief Task which runs F and satisfies the promise with its result. Used by executors to return Future.
+ */
+template <typename R, typename F>
+class PromiseTask {
+public:
+	PromiseTask(Promise<R>&& promise, F&& f) : promise(std::move(promise)), f(std::move(f)) { }
+	PromiseTask(Promise<R>&& promise, const F& f) : promise(std::move(promise)), f(f) { }
+
+	PromiseTask(PromiseTask&& other) = default;
+
+	void operator()() {
+		promise.setResultOf(f);
+	}
+
+private:
+	Promise<R> promise;
+	F f;
+};
+
+/**
+ * @brief Result type of continuation F of Future<T>.
+ */
+template <typename T, typename F>
+struct ContinuationResult {
+	typedef typename std::result_of<F(T)>::type type;
+};
+
+template <typename F>
+struct ContinuationResult<void, F> {
+	typedef typename std::result_of<F()>::type type;
+};
+
+template <typename State>
+class ContinuationTask;
+
+/**
+ * @brief State of the future returned by then(). It owns the input state and the continuation.
+ */
+template <typename T, typename F, typename R>
+class ThenState: public FutureState<R> {
+public:
+	ThenState(std::shared_ptr<FutureState<T>>&& input, F&& f)
+			: input(std::move(input)), f(std::move(f)), schedule_phase(IDLE) { }
+	ThenState(std::shared_ptr<FutureState<T>>&& input, const F& f)
+			: input(std::move(input)), f(f), schedule_phase(IDLE) { }
+
+	FutureState<T>& getInput() {
+		return *input;
+	}
+
+	/**
+	 * @brief Runs the continuation with the input value. The exception of the input is passed through without call.
+	 */
+	void run() {
+		std::shared_ptr<FutureState<T>> in = std::move(input);
+		if (in->exception()) {
+			this->setException(in->exception());
+		} else {
+			callWithInput(std::is_void<T>(), *in);
+		}
+	}
+
+	/**
+	 * @brief Queues run() onto the executor. If execute throws, e.g. RejectedExecutionException of
+	 * RejectionPolicy::abort, the future of the continuation gets that exception instead of broken_promise.
+	 */
+	template<typename Executor_>
+	static void schedule(Executor_& executor, const std::shared_ptr<ThenState>& self) {
+		self->schedule_phase.store(SCHEDULING);
+		try {
+			executor.execute(ContinuationTask<ThenState>(self));
+		} catch (...) {
+			// The rejected task is destroyed before this point, breakPromise left the state to us
+			self->schedule_phase.store(IDLE);
+			self->input.reset();
+			self->setException(std::current_exception());
+			return;
+		}
+		if (self->schedule_phase.exchange(IDLE) == DROPPED) self->breakPromise();
+	}
+
+	/**
+	 * @brief Called when the executor drops the task. While schedule is in execute, it only marks the drop, schedule
+	 * then sets the error.
+	 */
+	void breakPromise() {
+		if (schedule_phase.exchange(DROPPED) == SCHEDULING) return;
+		input.reset();
+		this->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+	}
+
+private:
+	enum SchedulePhase {
+		IDLE,
+		SCHEDULING,
+		DROPPED
+	};
+
+	void callWithInput(std::true_type, FutureState<T>&) {
+		this->setResultOf(f);
+	}
+
+	void callWithInput(std::false_type, FutureState<T>& in) {
+		this->setResultOf(f, in.take());
+	}
+
+	std::shared_ptr<FutureState<T>> input;
+	F f;
+	std::atomic<int> schedule_phase;
+};
+
+/**
+ * @brief Executor task which runs a continuation. If the executor drops the task, the future of the continuation gets
+ * broken_promise.
+ */
+template <typename State>
+class ContinuationTask {
+public:
+	explicit ContinuationTask(const std::shared_ptr<State>& state) : state(state) { }
+
+	ContinuationTask(ContinuationTask&& other) noexcept = default;
+
+	~ContinuationTask() {
+		if (state) state->breakPromise();
+	}
+
+	void operator()() {
+		std::shared_ptr<State> s = std::move(state);
+		s->run();
+	}
+
+private:
+	std::shared_ptr<State> state;
+};
+
+/**
+ * @brief Result of the future returned by whenAny: index of the first ready future and its value.
+ */
+template <typename T>
+struct WhenAnyResult {
+	size_t index;
+	T value;
+};
+
+/**
+ * @brief Tag of executor submit overloads which return Future instead of std::future.
+ */
+struct UseFuture { };
+
+static const UseFuture use_future = UseFuture();
+
+/**
+ * @brief Future with continuations. Unlike std::future it never needs a blocked thread to chain work: then() schedules
+ * the continuation onto an executor when the value is ready, whenAll and whenAny combine futures without waiting.
+ *
+ * get(), then() and whenAll/whenAny consume the future, only one of them may be called.
+ */
+template <typename T>
+class Future {
+public:
+	Future() { }
+
+	explicit Future(std::shared_ptr<FutureState<T>> state) : state(std::move(state)) { }
+
+	bool valid() const {
+		return state != nullptr;
+	}
+
+	bool isReady() const {
+		return state->isReady();
+	}
+
+	/**
+	 * @brief Same as isReady(), named after std::experimental::future::is_ready.
+	 */
+	bool ready() const {
+		return state->isReady();
+	}
+
+	void wait() const {
+		state->wait();
+	}
+
+	/**
+	 * @return true if the future is ready, false if timeout elapsed
+	 */
+	bool waitFor(int timeoutMs) const {
+		return state->waitFor(timeoutMs);
+	}
+
+	/**
+	 * @brief Same as std::future::wait_for, the future is never deferred.
+	 */
+	template<typename Rep, typename Period>
+	std::future_status wait_for(const std::chrono::duration<Rep, Period>& timeout) const {
+		return state->waitFor(timeout) ? std::future_status::ready : std::future_status::timeout;
+	}
+
+	/**
+	 * @brief Waits for the value and moves it out, or rethrows the stored exception. The future becomes invalid.
+	 */
+	T get() {
+		std::shared_ptr<FutureState<T>> s = std::move(state);
+		return static_cast<T>(s->take());
+	}
+
+	/**
+	 * @brief Schedules f(value) onto the executor when this future is ready. If this future holds an exception, f is not
+	 * called and the returned future gets the exception. The future becomes invalid.
+	 *
+	 * @param executor any executor with execute(runnable), it must outlive the continuation
+	 */
+	template<typename Executor_, typename FunctionType>
+	Future<typename ContinuationResult<T, FunctionType>::type> then(Executor_& executor, FunctionType&& f) {
+		typedef ThenState<T, typename std::decay<FunctionType>::type, typename ContinuationResult<T, FunctionType>::type> State;
+
+		std::shared_ptr<State> next = std::allocate_shared<State>(SlabStdAllocator<State>(), std::move(state),
+		                                                          std::forward<FunctionType>(f));
+		Executor_* e = &executor;
+		next->getInput().onReady(FunctionWrapper([e, next]() { State::schedule(*e, next); }));
+		return Future<typename ContinuationResult<T, FunctionType>::type>(next);
+	}
+
+	/**
+	 * @brief Calls f(value) in the thread which makes this future ready, or at once if it is ready. Suits cheap
+	 * continuations. The future becomes invalid.
+	 */
+	template<typename FunctionType>
+	Future<typename ContinuationResult<T, FunctionType>::type> then(FunctionType&& f) {
+		typedef ThenState<T, typename std::decay<FunctionType>::type, typename ContinuationResult<T, FunctionType>::type> State;
+
+		std::shared_ptr<State> next = std::allocate_shared<State>(SlabStdAllocator<State>(), std::move(state),
+		                                                          std::forward<FunctionType>(f));
+		next->getInput().onReady(FunctionWrapper([next]() { next->run(); }));
+		return Future<typename ContinuationResult<T, FunctionType>::type>(next);
+	}
+
+	/**
+	 * @brief Returns the shared state and makes the future invalid. Used by whenAll and whenAny.
+	 */
+	std::shared_ptr<FutureState<T>> release() {
+		return std::move(state);
+	}
+
+private:
+	std::shared_ptr<FutureState<T>> state;
+};
+
+template <typename T>
+struct WhenAllValue {
+	typedef std::vector<T> type;
+};
+
+template <>
+struct WhenAllValue<void> {
+	typedef void type;
+};
+
+/**
+ * @brief State of the future returned by whenAll. The last ready input collects the values.
+ */
+template <typename T>
+class WhenAllState: public FutureState<typename WhenAllValue<T>::type> {
+public:
+	explicit WhenAllState(std::vector<std::shared_ptr<FutureState<T>>>&& inputs) : inputs(std::move(inputs)),
+	                                                                             pending(this->inputs.size()) { }
+
+	const std::vector<std::shared_ptr<FutureState<T>>>& getInputs() const {
+		return inputs;
+	}
+
+	void inputReady() {
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+	}
+
+	/**
+	 * @brief Stores the values of inputs in their order, or the exception of the first failed input.
+	 */
+	void complete() {
+		for (auto& input : inputs) {
+			if (input->exception()) {
+				this->setException(input->exception());
+				inputs.clear();
+				return;
+			}
+		}
+		collect(std::is_void<T>());
+		inputs.clear();
+	}
+
+private:
+	void collect(std::true_type) {
+		this->setValue();
+	}
+
+	void collect(std::false_type) {
+		std::vector<T> values;
+		values.reserve(inputs.size());
+		for (auto& input : inputs) values.push_back(input->take());
+		this->setValue(std::move(values));
+	}
+
+	std::vector<std::shared_ptr<FutureState<T>>> inputs;
+	std::atomic<size_t> pending;
+};
+
+/**
+ * @brief Returns future which becomes ready when all futures are ready: with values of the futures in their order
+ * (nothing for void), or with the exception of the first failed future. The futures become invalid.
+ */
+template <typename T>
+Future<typename WhenAllValue<T>::type> whenAll(std::vector<Future<T>>& futures) {
+	std::vector<std::shared_ptr<FutureState<T>>> inputs;
+	inputs.reserve(futures.size());
+	for (auto& future : futures) inputs.push_back(future.release());
+
+	std::shared_ptr<WhenAllState<T>> all = std::allocate_shared<WhenAllState<T>>(SlabStdAllocator<WhenAllState<T>>(),
+	                                                                          std::move(inputs));
+	if (all->getInputs().empty()) {
+		all->complete();
+	} else {
+		for (auto& input : all->getInputs()) input->onReady(FunctionWrapper([all]() { all->inputReady(); }));
+	}
+	return Future<typename WhenAllValue<T>::type>(all);
+}
+
+/**
+ * @brief State of the future returned by executor submitAll: one result slot per task, the last finished task sets the
+ * future with the results in the order of tasks (nothing for void), or with the first exception.
+ *
+ * Results are written to separate slots without locks, R must be default constructible and move assignable.
+ */
+template <typename R>
+class BatchState: public FutureState<typename WhenAllValue<R>::type> {
+public:
+	explicit BatchState(size_t count)
+			: slots(std::is_void<R>::value ? 0 : count), pending(count), is_failed(false) {
+		if (count == 0) complete();
+	}
+
+	/**
+	 * @brief Runs f as the task with the given index and stores its result or exception.
+	 */
+	template<typename F>
+	void run(size_t index, F& f) {
+		try {
+			callAndStore(std::is_void<R>(), index, f);
+		} catch (...) {
+			fail(std::current_exception());
+			return;
+		}
+		itemDone();
+	}
+
+	/**
+	 * @brief Counts the task as finished with exception e. Only the first exception is kept.
+	 */
+	void fail(std::exception_ptr e) {
+		if (!is_failed.exchange(true, std::memory_order_acq_rel)) first_error = e;
+		itemDone();
+	}
+
+private:
+	typedef typename FutureValue<R>::type Value;
+
+	/**
+	 * @brief Keeps results of neighbouring tasks in separate objects, e.g. for R = bool.
+	 */
+	struct Slot {
+		Value value;
+	};
+
+	template<typename F>
+	void callAndStore(std::true_type, size_t, F& f) {
+		f();
+	}
+
+	template<typename F>
+	void callAndStore(std::false_type, size_t index, F& f) {
+		slots[index].value = f();
+	}
+
+	void itemDone() {
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+	}
+
+	void complete() {
+		if (is_failed.load(std::memory_order_acquire)) {
+			this->setException(first_error);
+		} else {
+			collect(std::is_void<R>());
+		}
+	}
+
+	void collect(std::true_type) {
+		this->setValue();
+	}
+
+	void collect(std::false_type) {
+		std::vector<R> values;
+		values.reserve(slots.size());
+		for (auto& slot : slots) values.push_back(std::move(slot.value));
+		slots.clear();
+		this->setValue(std::move(values));
+	}
+
+	std::vector<Slot> slots;
+	std::atomic<size_t> pending;
+	std::atomic<bool> is_failed;
+	std::exception_ptr first_error;
+};
+
+/**
+ * @brief Executor task of submitAll. If the executor drops the task, the batch gets std::future_error with
+ * broken_promise.
+ */
+template <typename R, typename F>
+class BatchTask {
+public:
+	BatchTask(const std::shared_ptr<BatchState<R>>& state, size_t index, F&& f)
+			: state(state), index(index), f(std::move(f)) { }
+	BatchTask(const std::shared_ptr<BatchState<R>>& state, size_t index, const F& f)
+			: state(state), index(index), f(f) { }
+
+	BatchTask(BatchTask&& other) = default;
+
+	~BatchTask() {
+		if (state) state->fail(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+	}
+
+	void operator()() {
+		std::shared_ptr<BatchState<R>> s = std::move(state);
+		s->run(index, f);
+	}
+
+private:
+	std::shared_ptr<BatchState<R>> state;
+	size_t index;
+	F f;
+};
+
+template <typename T>
+struct WhenAnyValue {
+	typedef WhenAnyResult<T> type;
+};
+
+template <>
+struct WhenAnyValue<void> {
+	typedef size_t type;
+};
+
+/**
+ * @brief State of the future returned by whenAny. The first ready input sets it, the others are ignored.
+ */
+template <typename T>
+class WhenAnyState: public FutureState<typename WhenAnyValue<T>::type> {
+public:
+	WhenAnyState() : is_done(false) { }
+
+	void inputReady(size_t index, FutureState<T>& input) {
+		if (is_done.exchange(true, std::memory_order_acq_rel)) return;
+		if (input.exception()) {
+			this->setException(input.exception());
+		} else {
+			complete(std::is_void<T>(), index, input);
+		}
+	}
+
+private:
+	void complete(std::true_type, size_t index, FutureState<T>&) {
+		this->setValue(index);
+	}
+
+	void complete(std::false_type, size_t index, FutureState<T>& input) {
+		this->setValue(WhenAnyResult<T>{index, input.take()});
+	}
+
+	std::atomic<bool> is_done;
+};
+
+/**
+ * @brief Returns future which becomes ready with the index and the value (only the index for void) of the first ready
+ * future, or with its exception. Values of the other futures are dropped. The futures become invalid. For an empty
+ * vector the future is ready at once with std::invalid_argument, as no future can ever be first.
+ */
+template <typename T>
+Future<typename WhenAnyValue<T>::type> whenAny(std::vector<Future<T>>& futures) {
+	std::shared_ptr<WhenAnyState<T>> any = std::allocate_shared<WhenAnyState<T>>(SlabStdAllocator<WhenAnyState<T>>());
+	if (futures.empty()) any->setException(std::make_exception_ptr(std::invalid_argument("whenAny: no futures")));
+	for (size_t i = 0; i < futures.size(); ++i) {
+		std::shared_ptr<FutureState<T>> input = futures[i].release();
+		FutureState<T>* in = input.get();
+		in->onReady(FunctionWrapper([any, i, in]() { any->inputReady(i, *in); }));
+	}
+	return Future<typename WhenAnyValue<T>::type>(any);
+}
+
+#endif // FUTURE_H
@@ -0,0 +1,370 @@
+#ifndef LOCKFREEDEQUEUE_H
+#define LOCKFREEDEQUEUE_H
+
+#include "blockingdequeue.h"
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Bounded multi-producer multi-consumer queue on top of a lock-free ring buffer. Each slot carries a sequence
+ * number, so producers and consumers claim slots with a single CAS on the cache line padded tail or head index.
+ * Blocking operations spin for a short time and park on a condition variable only when the ring is really empty
+ * (for consumers) or full (for producers).
+ *
+ * The interface repeats BlockingDequeue, so the class can be used as Dequeue_ of ThreadPoolExecutorTemplate.
+ *
+ * @note Ring algorithm from: "Dmitry Vyukov, Bounded MPMC queue"
+ * (http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue)
+ */
+template <typename T>
+class LockFreeDequeue {
+public:
+	typedef T ValueType;
+
+	/**
+	 * @brief Constructor. Capacity is rounded up to the nearest power of two.
+	 */
+	explicit LockFreeDequeue(size_t capacity = 1024)
+			: mask(roundUpToPowerOf2(capacity) - 1), buffer(new Cell[mask + 1]),
+			  enqueue_pos(0), dequeue_pos(0), waiting_producers(0), waiting_consumers(0), is_closed(false) {
+		for (size_t i = 0; i <= mask; ++i) buffer[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	~LockFreeDequeue() {
+		T t;
+		while (tryPop(t)) { }
+		delete[] buffer;
+	}
+
+	LockFreeDequeue(const LockFreeDequeue&) = delete;
+	LockFreeDequeue& operator=(const LockFreeDequeue&) = delete;
+
+	/**
+	 * @brief Inserts the specified element into this queue, waiting if necessary for space to become available.
+	 *
+	 * @param v the element to add
+	 * @return true if the element was added, false if the queue is closed
+	 */
+	template<typename Type>
+	bool put(Type && v) {
+		if (is_closed.load()) return false;
+		if (!tryPush(std::forward<Type>(v)) && !waitPush(std::forward<Type>(v), nullptr)) return false;
+		notifyConsumer();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts the specified element at the end of this queue if it is possible to do so immediately without
+	 * exceeding the queue's capacity, returning true upon success and false if this queue is full.
+	 *
+	 * @param v the element to add
+	 * @return true if the element was added to this queue, else false
+	 */
+	template<typename Type>
+	bool offer(Type && v) {
+		if (is_closed.load() || !tryPush(std::forward<Type>(v))) return false;
+		notifyConsumer();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts the specified element into this queue, waiting up to the specified wait time if necessary for
+	 * space to become available.
+	 *
+	 * @param v the element to add
+	 * @param timeoutMs how long to wait before giving up, in milliseconds
+	 * @return true if successful, or false if the specified waiting time elapses before space is available
+	 */
+	template<typename Type>
+	bool offer(Type && v, int timeoutMs) {
+		if (is_closed.load()) return false;
+		if (!tryPush(std::forward<Type>(v))) {
+			Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+			if (!waitPush(std::forward<Type>(v), &deadline)) return false;
+		}
+		notifyConsumer();
+		return true;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue, waiting if necessary until an element becomes available.
+	 *
+	 * @return the head of this queue
+	 * @throw DequeueClosedException if the queue is closed and drained
+	 */
+	T take() {
+		T t;
+		if (pollStatus(t, -1) == DequeueStatus::closed) throw DequeueClosedException();
+		return t;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue, waiting up to the specified wait time if necessary for an
+	 * element to become available.
+	 *
+	 * @param timeoutMs how long to wait before giving up, in milliseconds
+	 * @param defaultVal value, which returns if the specified waiting time elapses before an element is available
+	 * @param isOk flag, which indicates result of method execution. It will be set to false if timeout, or true if
+	 * return value is retrieved value
+	 * @return the head of this queue, or defaultVal if the specified waiting time elapses before an element is available
+	 */
+	template<typename Type = T>
+	T poll(int timeoutMs, Type && defaultVal = Type(), bool * isOk = nullptr) {
+		T t;
+		bool isNotEmpty = tryPop(t);
+		if (!isNotEmpty) {
+			Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+			isNotEmpty = waitPop(t, &deadline);
+		}
+		if (isNotEmpty) notifyProducer();
+		else t = std::forward<Type>(defaultVal);
+		if (isOk) *isOk = isNotEmpty;
+		return t;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue and return it if queue not empty, otherwise return defaultVal.
+	 * Do it immediately without waiting.
+	 *
+	 * @param defaultVal value, which returns if the queue is empty
+	 * @param isOk flag, which indicates result of method execution. It will be set to false if queue is empty, or true
+	 * if return value is retrieved value
+	 * @return the head of this queue, or defaultVal if the queue is empty
+	 */
+	template<typename Type = T>
+	T poll(Type && defaultVal = Type(), bool * isOk = nullptr) {
+		T t;
+		bool isNotEmpty = tryPop(t);
+		if (isNotEmpty) notifyProducer();
+		else t = std::forward<Type>(defaultVal);
+		if (isOk) *isOk = isNotEmpty;
+		return t;
+	}
+
+	/**
+	 * @brief Same as BlockingDequeue::takeStatus.
+	 */
+	DequeueStatus takeStatus(T& out) {
+		return pollStatus(out, -1);
+	}
+
+	/**
+	 * @brief Same as BlockingDequeue::pollStatus.
+	 *
+	 * @param timeoutMs how long to wait before giving up, in milliseconds, negative to wait without timeout
+	 */
+	DequeueStatus pollStatus(T& out, int timeoutMs) {
+		Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs < 0 ? 0 : timeoutMs);
+		while (!tryPop(out) && !waitPop(out, timeoutMs < 0 ? nullptr : &deadline)) {
+			if (!is_closed.load()) return DequeueStatus::timeout;
+			// Element of a put which raced with close may be still being written
+			if (size() == 0) return DequeueStatus::closed;
+		}
+		notifyProducer();
+		return DequeueStatus::ok;
+	}
+
+	/**
+	 * @brief Closes the queue: new elements are rejected, consumers take the remaining ones and then get closed status.
+	 * All waiting threads are woken up.
+	 */
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(wait_mutex);
+			is_closed.store(true);
+		}
+		not_empty.notify_all();
+		not_full.notify_all();
+	}
+
+	bool isClosed() const {
+		return is_closed.load();
+	}
+
+	/**
+	 * @brief Returns true if the queue is closed and has no elements.
+	 */
+	bool isDrained() const {
+		return is_closed.load() && size() == 0;
+	}
+
+	/**
+	 * @brief Returns the number of elements that this queue can contain.
+	 */
+	size_t capacity() const {
+		return mask + 1;
+	}
+
+	/**
+	 * @brief Returns the number of additional elements that this queue can accept. The value is a snapshot and may be
+	 * stale by the moment it is returned.
+	 */
+	size_t remainingCapacity() const {
+		return capacity() - size();
+	}
+
+	/**
+	 * @brief Returns the number of elements in this collection. The value is a snapshot and may be stale by the
+	 * moment it is returned.
+	 */
+	size_t size() const {
+		size_t head = dequeue_pos.load(std::memory_order_acquire);
+		size_t tail = enqueue_pos.load(std::memory_order_acquire);
+		if (tail <= head) return 0;
+		return tail - head > capacity() ? capacity() : tail - head;
+	}
+
+	/**
+	 * @brief Removes all available elements from this queue and adds them to other given queue.
+	 */
+	template<typename Appendable>
+	size_t drainTo(Appendable& other, size_t maxCount = SIZE_MAX) {
+		size_t count = 0;
+		T t;
+		while (count < maxCount && tryPop(t)) {
+			other.push_back(std::move(t));
+			++count;
+		}
+		if (count != 0) notifyProducer(true);
+		return count;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * Iterations of optimistic retry before a blocked caller parks on the condition variable.
+	 */
+	static const int SPIN_COUNT = 64;
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	};
+
+	template<typename Type>
+	bool tryPush(Type && v) {
+		size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;) {
+			cell = &buffer[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - pos);
+			if (dif == 0) {
+				if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		new (&cell->storage) T(std::forward<Type>(v));
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(T& t) {
+		size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+		Cell* cell;
+		for (;;) {
+			cell = &buffer[pos & mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			std::ptrdiff_t dif = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+			if (dif == 0) {
+				if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			} else if (dif < 0) {
+				return false;
+			} else {
+				pos = dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		T* value = reinterpret_cast<T*>(&cell->storage);
+		t = std::move(*value);
+		value->~T();
+		cell->sequence.store(pos + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename Type>
+	bool waitPush(Type && v, const Clock::time_point* deadline) {
+		for (int i = 0; i < SPIN_COUNT; ++i) {
+			cpuRelax();
+			if (tryPush(std::forward<Type>(v))) return true;
+		}
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		waiting_producers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		bool isOk;
+		while (!(isOk = tryPush(std::forward<Type>(v)))) {
+			if (is_closed.load()) break;
+			if (!deadline) {
+				not_full.wait(lock);
+			} else if (not_full.wait_until(lock, *deadline) == std::cv_status::timeout) {
+				isOk = tryPush(std::forward<Type>(v));
+				break;
+			}
+		}
+		waiting_producers.fetch_sub(1);
+		return isOk;
+	}
+
+	bool waitPop(T& t, const Clock::time_point* deadline) {
+		for (int i = 0; i < SPIN_COUNT; ++i) {
+			cpuRelax();
+			if (tryPop(t)) return true;
+		}
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		waiting_consumers.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		bool isOk;
+		while (!(isOk = tryPop(t))) {
+			if (is_closed.load()) break;
+			if (!deadline) {
+				not_empty.wait(lock);
+			} else if (not_empty.wait_until(lock, *deadline) == std::cv_status::timeout) {
+				isOk = tryPop(t);
+				break;
+			}
+		}
+		waiting_consumers.fetch_sub(1);
+		return isOk;
+	}
+
+	void notifyConsumer() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiting_consumers.load(std::memory_order_relaxed) == 0) return;
+		{ std::lock_guard<std::mutex> lock(wait_mutex); }
+		not_empty.notify_one();
+	}
+
+	void notifyProducer(bool all = false) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiting_producers.load(std::memory_order_relaxed) == 0) return;
+		{ std::lock_guard<std::mutex> lock(wait_mutex); }
+		if (all) not_full.notify_all();
+		else not_full.notify_one();
+	}
+
+	const size_t mask;
+	Cell* const buffer;
+
+	char pad0[CACHE_LINE_SIZE];
+	std::atomic<size_t> enqueue_pos;
+	char pad1[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> dequeue_pos;
+	char pad2[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+	std::atomic<size_t> waiting_producers;
+	std::atomic<size_t> waiting_consumers;
+	std::mutex wait_mutex;
+	std::condition_variable not_full, not_empty;
+	std::atomic<bool> is_closed;
+};
+
+#endif // LOCKFREEDEQUEUE_H
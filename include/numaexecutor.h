@@ -0,0 +1,210 @@
+#ifndef NUMAEXECUTOR_H
+#define NUMAEXECUTOR_H
+
+#include "cputopology.h"
+#include "executor.h"
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Thread pool with workers pinned to CPUs in the order of CpuPlacement. Every worker pins itself to the next CPU
+ * of placement.cpus(topology) before it allocates anything, extra workers of elastic pool continue the order.
+ */
+template <typename Dequeue_ = BlockingDequeue<FunctionWrapper, SlabDeque>>
+class AffinityThreadPoolExecutorTemplate: public ThreadPoolExecutorTemplate<std::thread, Dequeue_> {
+	typedef ThreadPoolExecutorTemplate<std::thread, Dequeue_> Base;
+
+public:
+	AffinityThreadPoolExecutorTemplate(size_t corePoolSize, const CpuPlacement& placement,
+	                                   const CpuTopology& topology = CpuTopology::detect())
+			: Base(corePoolSize, corePoolSize, 0, [](std::thread*) { }, pinner(placement.cpus(topology))) { }
+
+	AffinityThreadPoolExecutorTemplate(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs,
+	                                   const CpuPlacement& placement, const CpuTopology& topology = CpuTopology::detect())
+			: Base(corePoolSize, maximumPoolSize, keepAliveMs, [](std::thread*) { }, pinner(placement.cpus(topology))) { }
+
+private:
+	/**
+	 * @brief Returns onThreadStart hook which pins the calling worker to the next CPU.
+	 */
+	static std::function<void()> pinner(std::vector<int> cpus) {
+		std::shared_ptr<std::atomic<size_t>> next = std::make_shared<std::atomic<size_t>>(0);
+		return [cpus, next]() {
+			if (cpus.empty()) return;
+			setCurrentThreadAffinity(std::vector<int>(1, cpus[next->fetch_add(1) % cpus.size()]));
+		};
+	}
+};
+
+typedef AffinityThreadPoolExecutorTemplate<> AffinityThreadPoolExecutor;
+
+/**
+ * @brief Id of NUMA node, as in /sys/devices/system/node/nodeN.
+ */
+struct NumaNode {
+	explicit NumaNode(int id) : id(id) { }
+
+	int id;
+};
+
+/**
+ * @brief Executor with a sub-pool per NUMA node. Workers of a sub-pool are allowed to run on any CPU of their node and
+ * take tasks from the node-local queue, so tasks and data they touch stay on one node.
+ *
+ * Tasks without node go to the node of the calling thread, so a task submitted from a worker stays on its node. If the
+ * node of the caller is unknown, nodes are chosen in round-robin order. If the topology has no nodes, e.g. sysfs is not
+ * mounted, there is one unpinned sub-pool and every node is unknown.
+ */
+template <typename Dequeue_ = BlockingDequeue<FunctionWrapper, SlabDeque>>
+class NumaThreadPoolExecutorTemplate {
+	typedef ThreadPoolExecutorTemplate<std::thread, Dequeue_> Pool;
+
+	/**
+	 * @brief Sub-pool whose workers pin themselves to the CPU set of the node before they allocate anything. Empty set
+	 * leaves the workers unpinned.
+	 */
+	class NodePool: public Pool {
+	public:
+		NodePool(size_t corePoolSize, const std::vector<int>& cpus)
+				: Pool(corePoolSize, corePoolSize, 0, [](std::thread*) { }, [cpus]() { setCurrentThreadAffinity(cpus); }) { }
+	};
+
+public:
+	/**
+	 * @brief Constructor.
+	 *
+	 * @param threadsPerNode workers in every sub-pool, 0 means the number of CPUs of the node
+	 */
+	explicit NumaThreadPoolExecutorTemplate(size_t threadsPerNode = 0, const CpuTopology& topology = CpuTopology::detect())
+			: topology(topology), next_node(0) {
+		for (int node : topology.nodes()) {
+			std::vector<int> cpus = topology.cpusOfNode(node);
+			for (int cpu : cpus) {
+				if (static_cast<size_t>(cpu) >= pool_of_cpu.size()) pool_of_cpu.resize(static_cast<size_t>(cpu) + 1, -1);
+				pool_of_cpu[static_cast<size_t>(cpu)] = static_cast<int>(pools.size());
+			}
+			pools.push_back(makeNodePool(threadsPerNode == 0 ? cpus.size() : threadsPerNode, cpus));
+		}
+		if (pools.empty()) {
+			unsigned count = std::thread::hardware_concurrency();
+			size_t size = threadsPerNode != 0 ? threadsPerNode : (count == 0 ? 1 : count);
+			pools.emplace_back(new NodePool(size, std::vector<int>()));
+		}
+	}
+
+	template<typename FunctionType>
+	std::future<typename std::result_of<FunctionType()>::type> submit(FunctionType&& callable) {
+		return pools[callerPool()]->submit(std::forward<FunctionType>(callable));
+	}
+
+	/**
+	 * @brief Submits the task to the sub-pool of the node.
+	 *
+	 * @throw std::out_of_range if there is no such node
+	 */
+	template<typename FunctionType>
+	std::future<typename std::result_of<FunctionType()>::type> submit(NumaNode node, FunctionType&& callable) {
+		return pools[poolOf(node)]->submit(std::forward<FunctionType>(callable));
+	}
+
+	template<typename FunctionType>
+	void execute(FunctionType&& runnable) {
+		pools[callerPool()]->execute(std::forward<FunctionType>(runnable));
+	}
+
+	/**
+	 * @brief Executes the task in the sub-pool of the node.
+	 *
+	 * @throw std::out_of_range if there is no such node
+	 */
+	template<typename FunctionType>
+	void execute(NumaNode node, FunctionType&& runnable) {
+		pools[poolOf(node)]->execute(std::forward<FunctionType>(runnable));
+	}
+
+	void shutdown() {
+		for (auto& pool : pools) pool->shutdown();
+	}
+
+	void shutdownNow() {
+		for (auto& pool : pools) pool->shutdownNow();
+	}
+
+	bool isShutdown() const {
+		return pools.empty() || pools.front()->isShutdown();
+	}
+
+	bool awaitTermination(int timeoutMs) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		for (auto& pool : pools) {
+			auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+			if (!pool->awaitTermination(left.count() < 0 ? 0 : static_cast<int>(left.count()))) return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Returns NUMA node ids which have a sub-pool.
+	 */
+	const std::vector<int>& getNodes() const {
+		return topology.nodes();
+	}
+
+	size_t getPoolSize() const {
+		size_t size = 0;
+		for (auto& pool : pools) size += pool->getPoolSize();
+		return size;
+	}
+
+private:
+	CpuTopology topology;
+	std::vector<std::unique_ptr<NodePool>> pools;
+	std::vector<int> pool_of_cpu;
+	std::atomic<size_t> next_node;
+
+	/**
+	 * @brief Constructs the sub-pool in a thread pinned to the node, so the pool and its task queue are allocated from
+	 * the slab cache of a thread on the node and are first touched there.
+	 */
+	static std::unique_ptr<NodePool> makeNodePool(size_t corePoolSize, const std::vector<int>& cpus) {
+		std::unique_ptr<NodePool> pool;
+		std::exception_ptr error;
+		std::thread builder([&]() {
+			setCurrentThreadAffinity(cpus);
+			try {
+				pool.reset(new NodePool(corePoolSize, cpus));
+			} catch (...) {
+				error = std::current_exception();
+			}
+		});
+		builder.join();
+		if (error) std::rethrow_exception(error);
+		return pool;
+	}
+
+	size_t poolOf(NumaNode node) const {
+		const std::vector<int>& nodes = topology.nodes();
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			if (nodes[i] == node.id) return i;
+		}
+		throw std::out_of_range("NumaThreadPoolExecutor: unknown node " + std::to_string(node.id));
+	}
+
+	size_t callerPool() {
+		int cpu = currentCpu();
+		if (cpu >= 0 && static_cast<size_t>(cpu) < pool_of_cpu.size() && pool_of_cpu[static_cast<size_t>(cpu)] >= 0) {
+			return static_cast<size_t>(pool_of_cpu[static_cast<size_t>(cpu)]);
+		}
+		return next_node.fetch_add(1, std::memory_order_relaxed) % pools.size();
+	}
+};
+
+typedef NumaThreadPoolExecutorTemplate<> NumaThreadPoolExecutor;
+
+#endif // NUMAEXECUTOR_H
@@ -0,0 +1,241 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Chunks per thread when grain size is chosen automatically. Several chunks per thread let fast threads take
+ * the work of slow ones.
+ */
+static const size_t PARALLEL_CHUNKS_PER_THREAD = 8;
+
+/**
+ * @brief Returns the number of workers of the executor, or hardware concurrency if the executor does not report it.
+ */
+template <typename Executor_>
+auto parallelThreads(const Executor_& executor, int) -> decltype(static_cast<size_t>(executor.getPoolSize())) {
+	return executor.getPoolSize();
+}
+
+template <typename Executor_>
+size_t parallelThreads(const Executor_&, long) {
+	unsigned count = std::thread::hardware_concurrency();
+	return count == 0 ? 1 : count;
+}
+
+/**
+ * @brief Returns the number of chunks for n elements: n / grain, or PARALLEL_CHUNKS_PER_THREAD chunks per thread
+ * (workers and the caller) if grain is 0.
+ */
+inline size_t parallelChunkCount(size_t n, size_t threads, size_t grain) {
+	if (n == 0) return 0;
+	if (grain == 0) return std::min(n, (threads + 1) * PARALLEL_CHUNKS_PER_THREAD);
+	return (n + grain - 1) / grain;
+}
+
+/**
+ * @brief Bounds of chunk i when n elements are split into chunks of almost equal size.
+ */
+inline size_t parallelChunkBegin(size_t n, size_t chunks, size_t i) {
+	return n / chunks * i + std::min(i, n % chunks);
+}
+
+/**
+ * @brief Iterator to the beginning of chunk i of [first, first + n).
+ */
+template <typename RandomIt>
+RandomIt parallelChunkAt(RandomIt first, size_t n, size_t chunks, size_t i) {
+	return first + static_cast<typename std::iterator_traits<RandomIt>::difference_type>(parallelChunkBegin(n, chunks, i));
+}
+
+/**
+ * @brief Chunks of a parallel algorithm. Workers and the calling thread claim chunks from the shared counter, so the
+ * load is balanced without splitting the range up front. The first exception is kept, later chunks are skipped.
+ */
+template <typename Body>
+class ParallelJob {
+public:
+	ParallelJob(size_t chunks, Body&& body) : body(std::move(body)), chunks(chunks), next_chunk(0), done_chunks(0),
+	                                          is_failed(false) { }
+
+	/**
+	 * @brief Runs chunks until none is left.
+	 */
+	void run() {
+		for (;;) {
+			size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= chunks) return;
+
+			if (!is_failed.load(std::memory_order_relaxed)) {
+				try {
+					body(chunk);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!error) error = std::current_exception();
+					is_failed.store(true, std::memory_order_relaxed);
+				}
+			}
+
+			if (done_chunks.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+				std::lock_guard<std::mutex> lock(mutex);
+				cond.notify_all();
+			}
+		}
+	}
+
+	/**
+	 * @brief Waits until all chunks are done and rethrows the first exception of the body.
+	 */
+	void wait() {
+		if (done_chunks.load(std::memory_order_acquire) != chunks) {
+			std::unique_lock<std::mutex> lock(mutex);
+			cond.wait(lock, [this]() { return done_chunks.load(std::memory_order_acquire) == chunks; });
+		}
+		if (error) std::rethrow_exception(error);
+	}
+
+private:
+	Body body;
+	const size_t chunks;
+	std::atomic<size_t> next_chunk;
+	std::atomic<size_t> done_chunks;
+	std::atomic<bool> is_failed;
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::exception_ptr error;
+};
+
+/**
+ * @brief Calls body(i) for every chunk i in [0, chunks) on the executor and the calling thread, returns when all
+ * chunks are done. The calling thread runs chunks instead of sleeping, so nested calls from workers and executors
+ * which are shut down do not deadlock. Helper tasks which start after all chunks are taken exit at once. If the
+ * executor rejects a helper by throwing, no more helpers are queued and the calling thread runs the remaining chunks,
+ * so queued helpers never outlive the caller's frame with chunks to run.
+ *
+ * @throw the first exception thrown by body
+ */
+template<typename Executor_, typename Body>
+void parallelChunks(Executor_& executor, size_t chunks, Body&& body) {
+	if (chunks == 0) return;
+	if (chunks == 1) {
+		body(size_t(0));
+		return;
+	}
+
+	typedef ParallelJob<typename std::decay<Body>::type> Job;
+	std::shared_ptr<Job> job = std::make_shared<Job>(chunks, std::forward<Body>(body));
+	size_t helpers = std::min(chunks - 1, parallelThreads(executor, 0));
+	try {
+		for (size_t i = 0; i < helpers; ++i) executor.execute([job]() { job->run(); });
+	} catch (...) {
+		// Rejected helper, e.g. RejectionPolicy::abort on a full queue: the chunks still run on this thread
+	}
+	job->run();
+	job->wait();
+}
+
+/**
+ * @brief Calls f(i) for every i in [first, last) in parallel.
+ *
+ * @param grain indexes per chunk, 0 chooses it from the number of workers
+ */
+template<typename Executor_, typename Index, typename FunctionType>
+void parallelFor(Executor_& executor, Index first, Index last, FunctionType&& f, size_t grain = 0) {
+	static_assert(std::is_integral<Index>::value, "parallelFor: index must be integral");
+	if (!(first < last)) return;
+
+	size_t n = static_cast<size_t>(last - first);
+	size_t chunks = parallelChunkCount(n, parallelThreads(executor, 0), grain);
+	parallelChunks(executor, chunks, [&](size_t chunk) {
+		Index begin = static_cast<Index>(first + static_cast<Index>(parallelChunkBegin(n, chunks, chunk)));
+		Index end = static_cast<Index>(first + static_cast<Index>(parallelChunkBegin(n, chunks, chunk + 1)));
+		for (Index i = begin; i != end; ++i) f(i);
+	});
+}
+
+/**
+ * @brief Writes f(*it) to out for every element of [first, last) in parallel.
+ *
+ * @return iterator past the last written element
+ */
+template<typename Executor_, typename RandomIt, typename OutputIt, typename FunctionType>
+OutputIt parallelTransform(Executor_& executor, RandomIt first, RandomIt last, OutputIt out, FunctionType&& f,
+                           size_t grain = 0) {
+	size_t n = static_cast<size_t>(std::distance(first, last));
+	size_t chunks = parallelChunkCount(n, parallelThreads(executor, 0), grain);
+	parallelChunks(executor, chunks, [&](size_t chunk) {
+		std::transform(parallelChunkAt(first, n, chunks, chunk), parallelChunkAt(first, n, chunks, chunk + 1),
+		               parallelChunkAt(out, n, chunks, chunk), f);
+	});
+	return out + static_cast<typename std::iterator_traits<OutputIt>::difference_type>(n);
+}
+
+/**
+ * @brief Reduces [first, last) with op in parallel. Chunks are reduced independently and the partial results are
+ * combined in the order of chunks, so op must be associative but need not be commutative.
+ *
+ * @return init op e0 op e1 ... op eN
+ */
+template<typename Executor_, typename RandomIt, typename T, typename BinaryOp>
+T parallelReduce(Executor_& executor, RandomIt first, RandomIt last, T init, BinaryOp op, size_t grain = 0) {
+	size_t n = static_cast<size_t>(std::distance(first, last));
+	size_t chunks = parallelChunkCount(n, parallelThreads(executor, 0), grain);
+	std::vector<T> partials(chunks, init);
+	parallelChunks(executor, chunks, [&](size_t chunk) {
+		RandomIt begin = parallelChunkAt(first, n, chunks, chunk);
+		RandomIt end = parallelChunkAt(first, n, chunks, chunk + 1);
+		partials[chunk] = std::accumulate(begin + 1, end, T(*begin), op);
+	});
+	return std::accumulate(partials.begin(), partials.end(), init, op);
+}
+
+template<typename Executor_, typename RandomIt, typename T>
+T parallelReduce(Executor_& executor, RandomIt first, RandomIt last, T init) {
+	return parallelReduce(executor, first, last, init, std::plus<T>());
+}
+
+/**
+ * @brief Sorts [first, last) in parallel: chunks are sorted with std::sort, then neighbour runs are merged pairwise
+ * with std::inplace_merge, each round of merges in parallel. Not stable.
+ */
+template<typename Executor_, typename RandomIt, typename Compare>
+void parallelSort(Executor_& executor, RandomIt first, RandomIt last, Compare comp, size_t grain = 0) {
+	size_t n = static_cast<size_t>(std::distance(first, last));
+	size_t threads = parallelThreads(executor, 0);
+	// Every merge round halves parallelism, so sort uses one chunk per thread unless grain is given
+	size_t chunks = grain == 0 ? std::min(n, threads + 1) : parallelChunkCount(n, threads, grain);
+	if (chunks < 2) {
+		std::sort(first, last, comp);
+		return;
+	}
+
+	auto at = [&](size_t chunk) { return parallelChunkAt(first, n, chunks, std::min(chunk, chunks)); };
+	parallelChunks(executor, chunks, [&](size_t chunk) { std::sort(at(chunk), at(chunk + 1), comp); });
+	for (size_t width = 1; width < chunks; width *= 2) {
+		size_t merges = (chunks + 2 * width - 1) / (2 * width);
+		parallelChunks(executor, merges, [&](size_t merge) {
+			size_t begin = merge * 2 * width;
+			if (begin + width < chunks) std::inplace_merge(at(begin), at(begin + width), at(begin + 2 * width), comp);
+		});
+	}
+}
+
+template<typename Executor_, typename RandomIt>
+void parallelSort(Executor_& executor, RandomIt first, RandomIt last) {
+	parallelSort(executor, first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+#endif // PARALLEL_H
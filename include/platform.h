@@ -0,0 +1,48 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <cstddef>
+#include <thread>
+
+/**
+ * @brief Assumed size of the CPU cache line. Fields which are written by different threads are placed at least this
+ * far apart to avoid false sharing.
+ */
+static const size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Member which keeps its neighbours CACHE_LINE_SIZE bytes apart if Enabled_, and takes no more than padding of
+ * an empty member otherwise.
+ */
+template <bool Enabled_>
+struct CacheLinePad {
+	char pad[CACHE_LINE_SIZE];
+};
+
+template <>
+struct CacheLinePad<false> { };
+
+/**
+ * @brief Returns the smallest power of two which is not less than v, at least 2. Ring buffers use it for their
+ * capacity, so an index maps to a slot with a mask.
+ */
+inline size_t roundUpToPowerOf2(size_t v) {
+	size_t p = 2;
+	while (p < v) p <<= 1;
+	return p;
+}
+
+/**
+ * @brief Hints the processor that the calling thread is in a spin-wait loop.
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	__asm__ __volatile__("yield");
+#else
+	std::this_thread::yield();
+#endif
+}
+
+#endif // PLATFORM_H
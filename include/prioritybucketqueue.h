@@ -0,0 +1,89 @@
+#ifndef PRIORITYBUCKETQUEUE_H
+#define PRIORITYBUCKETQUEUE_H
+
+#include <cstddef>
+#include <deque>
+
+/**
+ * @brief Default configuration of PriorityBucketQueue: 8 priority levels, element priority is taken from its priority()
+ * method, a waiting level is served after it was passed over 32 times.
+ */
+struct DefaultPriorityPolicy {
+	static const size_t LEVELS = 8;
+	static const size_t AGING_THRESHOLD = 32;
+
+	template<typename T>
+	static size_t levelOf(const T& t) {
+		int priority = t.priority();
+		if (priority < 0) return 0;
+		if (static_cast<size_t>(priority) >= LEVELS) return LEVELS - 1;
+		return static_cast<size_t>(priority);
+	}
+};
+
+/**
+ * @brief Priority container with FIFO bucket per priority level. It can be used as Queue_ of BlockingDequeue.
+ *
+ * front() and pop_front() refer to the oldest element of the highest non-empty level. To avoid starvation every
+ * non-empty level counts how many times it was passed over; when the counter reaches Policy_::AGING_THRESHOLD the level
+ * is served next regardless of its priority.
+ */
+template <typename T, typename Policy_ = DefaultPriorityPolicy>
+class PriorityBucketQueue {
+public:
+	PriorityBucketQueue() : count(0), skipped() { }
+
+	void push_back(const T& t) {
+		buckets[Policy_::levelOf(t)].push_back(t);
+		++count;
+	}
+
+	void push_back(T&& t) {
+		size_t level = Policy_::levelOf(t);
+		buckets[level].push_back(std::move(t));
+		++count;
+	}
+
+	T& front() {
+		return buckets[selectLevel()].front();
+	}
+
+	void pop_front() {
+		size_t selected = selectLevel();
+		buckets[selected].pop_front();
+		--count;
+		skipped[selected] = 0;
+		for (size_t level = 0; level < Policy_::LEVELS; ++level) {
+			if (level != selected && !buckets[level].empty()) ++skipped[level];
+		}
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+private:
+	/**
+	 * @brief Returns the highest level which reached the aging threshold, or the highest non-empty level if no level
+	 * starves. Depends only on the queue state, so front() and the following pop_front() select the same level.
+	 */
+	size_t selectLevel() const {
+		size_t highest = Policy_::LEVELS;
+		for (size_t level = Policy_::LEVELS; level-- > 0;) {
+			if (buckets[level].empty()) continue;
+			if (skipped[level] >= Policy_::AGING_THRESHOLD) return level;
+			if (highest == Policy_::LEVELS) highest = level;
+		}
+		return highest;
+	}
+
+	std::deque<T> buckets[Policy_::LEVELS];
+	size_t count;
+	size_t skipped[Policy_::LEVELS];
+};
+
+#endif // PRIORITYBUCKETQUEUE_H
@@ -0,0 +1,37 @@
+#ifndef PRIORITYEXECUTOR_H
+#define PRIORITYEXECUTOR_H
+
+#include "executor.h"
+#include "prioritybucketqueue.h"
+
+/**
+ * @brief FunctionWrapper with priority. Tasks without explicit priority get NORM_PRIORITY.
+ */
+class PriorityTask: public FunctionWrapper {
+public:
+	static const int MIN_PRIORITY = 0;
+	static const int NORM_PRIORITY = 3;
+	static const int MAX_PRIORITY = 7;
+
+	PriorityTask() noexcept : task_priority(NORM_PRIORITY) { }
+	PriorityTask(FunctionWrapper&& task) noexcept : FunctionWrapper(std::move(task)), task_priority(NORM_PRIORITY) { }
+	PriorityTask(int priority, FunctionWrapper&& task) noexcept : FunctionWrapper(std::move(task)), task_priority(priority) { }
+
+	PriorityTask(PriorityTask&& other) noexcept = default;
+	PriorityTask& operator=(PriorityTask&& other) noexcept = default;
+
+	int priority() const { return task_priority; }
+
+private:
+	int task_priority;
+};
+
+/**
+ * @brief Thread pool which runs tasks with higher priority first. Use submit(priority, callable) and
+ * execute(priority, runnable) to set priority, priorities are in range [PriorityTask::MIN_PRIORITY,
+ * PriorityTask::MAX_PRIORITY]. Waiting tasks of lower priority age and are eventually served even under a constant
+ * stream of higher priority tasks.
+ */
+typedef ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<PriorityTask, PriorityBucketQueue>> PriorityThreadPoolExecutor;
+
+#endif // PRIORITYEXECUTOR_H
@@ -0,0 +1,194 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Contiguous FIFO queue on a power-of-two circular buffer. The buffer grows twice when full and never shrinks,
+ * so a queue whose size oscillates stops allocating after warm-up, unlike std::deque which frees and allocates chunks.
+ * Can be used as Queue_ of BlockingDequeue instead of std::deque.
+ */
+template <typename T, typename Allocator_ = std::allocator<T>>
+class RingBuffer {
+	typedef std::allocator_traits<Allocator_> Traits;
+
+public:
+	typedef T value_type;
+
+	static const size_t MIN_CAPACITY = 16;
+
+	explicit RingBuffer(const Allocator_& allocator = Allocator_())
+			: allocator(allocator), buffer(nullptr), mask(0), head(0), count(0) { }
+
+	RingBuffer(const RingBuffer& other) : RingBuffer(Traits::select_on_container_copy_construction(other.allocator)) {
+		reserve(other.count);
+		for (size_t i = 0; i < other.count; ++i) push_back(other.at(i));
+	}
+
+	RingBuffer(RingBuffer&& other) noexcept
+			: allocator(std::move(other.allocator)), buffer(nullptr), mask(0), head(0), count(0) {
+		steal(other);
+	}
+
+	RingBuffer& operator=(const RingBuffer& other) {
+		if (this != &other) {
+			clear();
+			reserve(other.count);
+			for (size_t i = 0; i < other.count; ++i) push_back(other.at(i));
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Takes over the buffer of other if the allocator propagates on move assignment or the allocators are equal,
+	 * otherwise moves the elements one by one into the own buffer, as standard containers do.
+	 */
+	RingBuffer& operator=(RingBuffer&& other) noexcept(Traits::propagate_on_container_move_assignment::value) {
+		if (this != &other) moveAssign(other, typename Traits::propagate_on_container_move_assignment());
+		return *this;
+	}
+
+	~RingBuffer() {
+		release();
+	}
+
+	void push_back(const T& t) {
+		emplace_back(t);
+	}
+
+	void push_back(T&& t) {
+		emplace_back(std::move(t));
+	}
+
+	template<typename... Args>
+	void emplace_back(Args&&... args) {
+		if (count == capacity()) grow(count == 0 ? MIN_CAPACITY : count * 2);
+		Traits::construct(allocator, buffer + ((head + count) & mask), std::forward<Args>(args)...);
+		++count;
+	}
+
+	T& front() {
+		return buffer[head];
+	}
+
+	const T& front() const {
+		return buffer[head];
+	}
+
+	T& back() {
+		return at(count - 1);
+	}
+
+	void pop_front() {
+		Traits::destroy(allocator, buffer + head);
+		head = (head + 1) & mask;
+		--count;
+	}
+
+	/**
+	 * @brief Returns i-th element from the front.
+	 */
+	T& at(size_t i) {
+		return buffer[(head + i) & mask];
+	}
+
+	const T& at(size_t i) const {
+		return buffer[(head + i) & mask];
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	size_t capacity() const {
+		return buffer ? mask + 1 : 0;
+	}
+
+	/**
+	 * @brief Makes room for at least n elements, rounded up to a power of two.
+	 */
+	void reserve(size_t n) {
+		if (n <= capacity()) return;
+		size_t newCapacity = MIN_CAPACITY;
+		while (newCapacity < n) newCapacity *= 2;
+		grow(newCapacity);
+	}
+
+	/**
+	 * @brief Destroys all elements, the buffer is kept.
+	 */
+	void clear() {
+		while (count != 0) pop_front();
+		head = 0;
+	}
+
+private:
+	void moveAssign(RingBuffer& other, std::true_type) {
+		release();
+		allocator = std::move(other.allocator);
+		steal(other);
+	}
+
+	void moveAssign(RingBuffer& other, std::false_type) {
+		if (allocator == other.allocator) {
+			release();
+			steal(other);
+			return;
+		}
+		clear();
+		reserve(other.count);
+		for (size_t i = 0; i < other.count; ++i) push_back(std::move(other.at(i)));
+		other.clear();
+	}
+
+	/**
+	 * @brief Takes the buffer of other, which must be freed with an allocator equal to the own one.
+	 */
+	void steal(RingBuffer& other) {
+		buffer = other.buffer;
+		mask = other.mask;
+		head = other.head;
+		count = other.count;
+		other.buffer = nullptr;
+		other.mask = other.head = other.count = 0;
+	}
+
+	void grow(size_t newCapacity) {
+		T* newBuffer = Traits::allocate(allocator, newCapacity);
+		for (size_t i = 0; i < count; ++i) {
+			T& t = at(i);
+			Traits::construct(allocator, newBuffer + i, std::move_if_noexcept(t));
+			Traits::destroy(allocator, &t);
+		}
+		if (buffer) Traits::deallocate(allocator, buffer, mask + 1);
+		buffer = newBuffer;
+		mask = newCapacity - 1;
+		head = 0;
+	}
+
+	void release() {
+		clear();
+		if (buffer) Traits::deallocate(allocator, buffer, mask + 1);
+		buffer = nullptr;
+		mask = 0;
+	}
+
+	Allocator_ allocator;
+	T* buffer;
+	size_t mask;
+	size_t head;
+	size_t count;
+};
+
+template <typename T, typename Allocator_>
+const size_t RingBuffer<T, Allocator_>::MIN_CAPACITY;
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,296 @@
+#ifndef SCHEDULEDEXECUTOR_H
+#define SCHEDULEDEXECUTOR_H
+
+#include "executor.h"
+#include "timingwheel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+class TimerQueue;
+
+/**
+ * @brief Delayed or periodic task of ScheduledThreadPoolExecutor. While the task waits in the timing wheel, the wheel
+ * owns it through the self reference.
+ */
+class ScheduledTask: public TimerNode {
+public:
+	enum state_t {
+		scheduled,
+		done,
+		cancelled
+	};
+
+	ScheduledTask(const std::shared_ptr<TimerQueue>& queue, FunctionWrapper&& function, int64_t period, bool isFixedRate)
+			: queue(queue), function(std::move(function)), period(period), is_fixed_rate(isFixedRate), state(scheduled) { }
+
+	std::shared_ptr<TimerQueue> queue;
+	FunctionWrapper function;
+	const int64_t period;
+	const bool is_fixed_rate;
+	std::atomic<state_t> state;
+	std::shared_ptr<ScheduledTask> self;
+};
+
+/**
+ * @brief Timing wheel of ScheduledThreadPoolExecutor with 1 ms tick, guarded by mutex. It outlives the executor while
+ * handles of its tasks exist.
+ */
+class TimerQueue {
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	TimerQueue() : origin(Clock::now()), wakeup_tick(0), is_stopped(false) { }
+
+	uint64_t nowTick() const {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - origin).count());
+	}
+
+	/**
+	 * @brief Inserts the task into the wheel with the given deadline and wakes up the timer thread if it sleeps longer.
+	 *
+	 * @return false if the queue is stopped or the task is cancelled
+	 */
+	bool insert(const std::shared_ptr<ScheduledTask>& task, uint64_t deadline) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (is_stopped || task->state != ScheduledTask::scheduled) return false;
+		task->deadline = deadline;
+		task->self = task;
+		wheel.insert(task.get());
+		if (task->deadline < wakeup_tick) cond.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Marks the task as cancelled and removes it from the wheel.
+	 *
+	 * @return true if the task was scheduled before the call
+	 */
+	bool cancel(ScheduledTask* task) {
+		std::shared_ptr<ScheduledTask> self;
+		std::lock_guard<std::mutex> lock(mutex);
+		ScheduledTask::state_t expected = ScheduledTask::scheduled;
+		if (!task->state.compare_exchange_strong(expected, ScheduledTask::cancelled)) return false;
+		if (task->isLinked()) {
+			wheel.remove(task);
+			self = std::move(task->self);
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Runs the task in the calling thread and puts a periodic task back into the wheel.
+	 */
+	static void run(const std::shared_ptr<ScheduledTask>& task) {
+		if (task->state != ScheduledTask::scheduled) return;
+		task->function();
+		if (task->period == 0) {
+			ScheduledTask::state_t expected = ScheduledTask::scheduled;
+			task->state.compare_exchange_strong(expected, ScheduledTask::done);
+			return;
+		}
+		TimerQueue& queue = *task->queue;
+		uint64_t deadline = (task->is_fixed_rate ? task->deadline : queue.nowTick()) + static_cast<uint64_t>(task->period);
+		if (!queue.insert(task, deadline)) {
+			ScheduledTask::state_t expected = ScheduledTask::scheduled;
+			task->state.compare_exchange_strong(expected, ScheduledTask::cancelled);
+		}
+	}
+
+	/**
+	 * @brief Waits until some tasks expire and moves them to expired. Returns without tasks if the queue is stopped.
+	 */
+	void awaitExpired(std::vector<std::shared_ptr<ScheduledTask>>& expired) {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!is_stopped) {
+			wheel.advance(nowTick(), [&](TimerNode* node) {
+				expired.push_back(std::move(static_cast<ScheduledTask*>(node)->self));
+			});
+			if (!expired.empty()) break;
+
+			wakeup_tick = wheel.nextTick();
+			if (wakeup_tick == UINT64_MAX) {
+				cond.wait(lock);
+			} else {
+				cond.wait_until(lock, origin + std::chrono::milliseconds(wakeup_tick));
+			}
+			wakeup_tick = 0;
+		}
+	}
+
+	/**
+	 * @brief Cancels all waiting tasks, new tasks are rejected.
+	 */
+	void stop() {
+		std::vector<std::shared_ptr<ScheduledTask>> removed;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopped = true;
+			wheel.clear([&](TimerNode* node) {
+				ScheduledTask* task = static_cast<ScheduledTask*>(node);
+				task->state = ScheduledTask::cancelled;
+				removed.push_back(std::move(task->self));
+			});
+		}
+		cond.notify_all();
+	}
+
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return wheel.size();
+	}
+
+private:
+	const Clock::time_point origin;
+	std::mutex mutex;
+	std::condition_variable cond;
+	TimingWheel wheel;
+	uint64_t wakeup_tick;
+	bool is_stopped;
+};
+
+/**
+ * @brief Handle of a task of ScheduledThreadPoolExecutor.
+ */
+class ScheduledHandle {
+public:
+	ScheduledHandle() { }
+
+	explicit ScheduledHandle(const std::shared_ptr<ScheduledTask>& task) : task(task) { }
+
+	/**
+	 * @brief Prevents further runs of the task. A run which has already started is not interrupted.
+	 *
+	 * @return true if the task was waiting for the next run, false if it is empty, done or already cancelled
+	 */
+	bool cancel() {
+		return task && task->queue->cancel(task.get());
+	}
+
+	bool isCancelled() const {
+		return task && task->state == ScheduledTask::cancelled;
+	}
+
+	/**
+	 * @brief Returns true if the task will not run any more: one-shot task has run or the task was cancelled.
+	 */
+	bool isDone() const {
+		return task && task->state != ScheduledTask::scheduled;
+	}
+
+	explicit operator bool() const noexcept { return task != nullptr; }
+
+private:
+	std::shared_ptr<ScheduledTask> task;
+};
+
+/**
+ * @brief Thread pool which also runs tasks after a delay or periodically. Waiting tasks are kept in a hierarchical
+ * timing wheel with 1 ms resolution, so insert and cancel are O(1) regardless of the number of pending tasks. The
+ * single timer thread moves due tasks into the task queue of the pool.
+ *
+ * Shutdown cancels the tasks which wait in the timing wheel, tasks already moved into the task queue are still run.
+ */
+template <typename Thread_ = std::thread, typename Dequeue_ = BlockingDequeue<FunctionWrapper, SlabDeque>>
+class ScheduledThreadPoolExecutorTemplate: public ThreadPoolExecutorTemplate<Thread_, Dequeue_> {
+	typedef ThreadPoolExecutorTemplate<Thread_, Dequeue_> Base;
+
+public:
+#ifdef CONCURRENT_COROUTINES
+	using Base::schedule;
+#endif
+
+	explicit ScheduledThreadPoolExecutorTemplate(size_t corePoolSize = 1)
+			: Base(corePoolSize), timerQueue(std::make_shared<TimerQueue>()), timerThread(nullptr) {
+		timerThread = new Thread_([this]() {
+			std::vector<std::shared_ptr<ScheduledTask>> expired;
+			for (;;) {
+				timerQueue->awaitExpired(expired);
+				if (expired.empty()) break;
+				for (auto& task : expired) Base::execute([task]() { TimerQueue::run(task); });
+				expired.clear();
+			}
+		});
+	}
+
+	~ScheduledThreadPoolExecutorTemplate() override {
+		timerQueue->stop();
+		timerThread->join();
+		delete timerThread;
+	}
+
+	/**
+	 * @brief Runs the task once after the delay.
+	 *
+	 * @return handle to cancel the task, empty handle if the executor is shut down
+	 */
+	template<typename FunctionType>
+	ScheduledHandle schedule(int delayMs, FunctionType&& runnable) {
+		return scheduleTask(delayMs, 0, false, std::forward<FunctionType>(runnable));
+	}
+
+	/**
+	 * @brief Runs the task after initialDelayMs, then every periodMs counted from the previous planned start. If a run
+	 * takes longer than the period, the next run starts late, runs of the same task never overlap.
+	 *
+	 * @return handle to cancel the task, empty handle if the executor is shut down
+	 * @throw std::invalid_argument if periodMs is not positive
+	 */
+	template<typename FunctionType>
+	ScheduledHandle scheduleAtFixedRate(int initialDelayMs, int periodMs, FunctionType&& runnable) {
+		if (periodMs < 1) throw std::invalid_argument("ScheduledThreadPoolExecutor: period must be positive");
+		return scheduleTask(initialDelayMs, periodMs, true, std::forward<FunctionType>(runnable));
+	}
+
+	/**
+	 * @brief Runs the task after initialDelayMs, then every time delayMs after the previous run completes.
+	 *
+	 * @return handle to cancel the task, empty handle if the executor is shut down
+	 * @throw std::invalid_argument if delayMs is not positive
+	 */
+	template<typename FunctionType>
+	ScheduledHandle scheduleWithFixedDelay(int initialDelayMs, int delayMs, FunctionType&& runnable) {
+		if (delayMs < 1) throw std::invalid_argument("ScheduledThreadPoolExecutor: delay must be positive");
+		return scheduleTask(initialDelayMs, delayMs, false, std::forward<FunctionType>(runnable));
+	}
+
+	/**
+	 * @brief Returns the number of tasks which wait in the timing wheel.
+	 */
+	size_t getScheduledCount() const {
+		return timerQueue->size();
+	}
+
+protected:
+	std::shared_ptr<TimerQueue> timerQueue;
+	Thread_* timerThread;
+
+	/**
+	 * @brief Cancels the tasks which wait in the timing wheel.
+	 */
+	void onShutdown() override {
+		timerQueue->stop();
+	}
+
+	/**
+	 * @param periodMs period of the task, 0 for one-shot task
+	 */
+	template<typename FunctionType>
+	ScheduledHandle scheduleTask(int delayMs, int periodMs, bool isFixedRate, FunctionType&& runnable) {
+		if (this->thread_command_ != Base::thread_command::run) return ScheduledHandle();
+
+		std::shared_ptr<ScheduledTask> task = std::make_shared<ScheduledTask>(
+				timerQueue, FunctionWrapper(std::forward<FunctionType>(runnable)), periodMs, isFixedRate);
+		uint64_t delay = delayMs < 0 ? 0 : static_cast<uint64_t>(delayMs);
+		if (!timerQueue->insert(task, timerQueue->nowTick() + delay)) return ScheduledHandle();
+		return ScheduledHandle(task);
+	}
+};
+
+typedef ScheduledThreadPoolExecutorTemplate<> ScheduledThreadPoolExecutor;
+
+#endif // SCHEDULEDEXECUTOR_H
@@ -0,0 +1,178 @@
+#ifndef SELECTOR_H
+#define SELECTOR_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Waiter of pollAny, shared by all queues it waits on. Queues signal it when they get elements.
+ */
+class Selector {
+public:
+	Selector() : is_signaled(false) { }
+
+	void signal() {
+		std::lock_guard<std::mutex> lock(mutex);
+		is_signaled = true;
+		cond.notify_one();
+	}
+
+	/**
+	 * @brief Clears the signal. Called before queues are checked, so a signal which comes after the check is not lost.
+	 */
+	void reset() {
+		std::lock_guard<std::mutex> lock(mutex);
+		is_signaled = false;
+	}
+
+	/**
+	 * @return false if the deadline passed without signal
+	 */
+	template<typename Clock, typename Duration>
+	bool waitUntil(const std::chrono::time_point<Clock, Duration>& deadline) {
+		std::unique_lock<std::mutex> lock(mutex);
+		return cond.wait_until(lock, deadline, [this]() { return is_signaled; });
+	}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return is_signaled; });
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool is_signaled;
+};
+
+/**
+ * @brief Registration of a selector in one queue.
+ */
+struct SelectorNode {
+	SelectorNode* prev = nullptr;
+	SelectorNode* next = nullptr;
+	Selector* selector = nullptr;
+};
+
+/**
+ * @brief Intrusive list of selectors waiting on a queue. Not thread-safe, guarded by the mutex of the queue.
+ */
+class SelectorList {
+public:
+	bool empty() const {
+		return head == nullptr;
+	}
+
+	void attach(SelectorNode* node) {
+		node->prev = nullptr;
+		node->next = head;
+		if (head) head->prev = node;
+		head = node;
+	}
+
+	void detach(SelectorNode* node) {
+		if (node->prev) node->prev->next = node->next;
+		else head = node->next;
+		if (node->next) node->next->prev = node->prev;
+		node->prev = node->next = nullptr;
+	}
+
+	void signalAll() {
+		for (SelectorNode* node = head; node; node = node->next) node->selector->signal();
+	}
+
+private:
+	SelectorNode* head = nullptr;
+};
+
+/**
+ * @brief Result of pollAny: index of the queue and the element taken from it, index is -1 if timeout elapsed or all
+ * queues are closed and drained.
+ */
+template <typename T>
+struct PollAnyResult {
+	int index;
+	T value;
+
+	explicit operator bool() const noexcept { return index >= 0; }
+};
+
+/**
+ * @brief Takes the head of the first non-empty queue in the order of queues.
+ *
+ * @return true if the element is taken or all queues are closed and drained, so waiting is useless
+ */
+template<typename Queue_>
+bool tryPollAny(Queue_* const* queues, size_t count, PollAnyResult<typename Queue_::ValueType>& result) {
+	bool isAllDrained = true;
+	for (size_t i = 0; i < count; ++i) {
+		if (queues[i]->tryPoll(result.value)) {
+			result.index = static_cast<int>(i);
+			return true;
+		}
+		isAllDrained = isAllDrained && queues[i]->isDrained();
+	}
+	return isAllDrained;
+}
+
+/**
+ * @brief Waits up to timeoutMs for an element in any of the queues and takes it. If several queues have elements, the
+ * queue with the lowest index wins, so the order of queues is their priority. The caller registers one selector in
+ * all queues and sleeps until some of them gets an element, without spinning over the queues.
+ *
+ * @param nodes storage for registrations, one per queue
+ * @param timeoutMs how long to wait before giving up, in milliseconds, negative to wait without timeout
+ */
+template<typename Queue_>
+PollAnyResult<typename Queue_::ValueType> pollAny(Queue_* const* queues, SelectorNode* nodes, size_t count,
+                                                  int timeoutMs) {
+	typedef typename Queue_::ValueType T;
+	PollAnyResult<T> result = {-1, T()};
+	if (tryPollAny(queues, count, result) || timeoutMs == 0) return result;
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	Selector selector;
+	for (size_t i = 0; i < count; ++i) {
+		nodes[i].selector = &selector;
+		queues[i]->attachSelector(&nodes[i]);
+	}
+
+	for (;;) {
+		selector.reset();
+		if (tryPollAny(queues, count, result)) break;
+		if (timeoutMs < 0) {
+			selector.wait();
+		} else if (!selector.waitUntil(deadline)) {
+			tryPollAny(queues, count, result);
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < count; ++i) queues[i]->detachSelector(&nodes[i]);
+	return result;
+}
+
+/**
+ * @brief pollAny over the queues given as arguments, lower argument index has higher priority. Does not allocate.
+ */
+template<typename Queue_, typename... Queues>
+PollAnyResult<typename Queue_::ValueType> pollAny(int timeoutMs, Queue_& first, Queues&... rest) {
+	std::array<Queue_*, 1 + sizeof...(Queues)> queues = {{&first, &rest...}};
+	std::array<SelectorNode, 1 + sizeof...(Queues)> nodes;
+	return pollAny(queues.data(), nodes.data(), queues.size(), timeoutMs);
+}
+
+/**
+ * @brief pollAny over the vector of queues, lower index has higher priority.
+ */
+template<typename Queue_>
+PollAnyResult<typename Queue_::ValueType> pollAny(const std::vector<Queue_*>& queues, int timeoutMs) {
+	std::vector<SelectorNode> nodes(queues.size());
+	return pollAny(queues.data(), nodes.data(), queues.size(), timeoutMs);
+}
+
+#endif // SELECTOR_H
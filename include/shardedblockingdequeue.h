@@ -0,0 +1,337 @@
+#ifndef SHARDEDBLOCKINGDEQUEUE_H
+#define SHARDEDBLOCKINGDEQUEUE_H
+
+#include "blockingdequeue.h"
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+/**
+ * @brief Order of elements in ShardedBlockingDequeue.
+ *
+ * - per_producer - every producer thread always puts to the same shard, so elements of one producer are taken in the
+ *   order they were put
+ * - none - producers spread elements over all shards and go to another shard when theirs is full, there is no order
+ */
+enum class ShardOrder {
+	per_producer,
+	none
+};
+
+/**
+ * @brief Blocking queue split into shards, every shard is a BlockingDequeue with its own lock. Producer threads are
+ * hashed onto shards, so many producers do not serialize on one mutex. Consumers scan the shards starting from their
+ * own offset and sleep on a shared condition variable only when all shards are empty.
+ *
+ * There is no FIFO order between shards, see ShardOrder. The capacity is split evenly between the shards. size() is
+ * maintained by one atomic counter, it is exact when the queue is quiescent.
+ *
+ * The interface follows BlockingDequeue, including putAll, offerAll, close and the status API, so the queue can be used
+ * as Dequeue_ of ThreadPoolExecutorTemplate.
+ */
+template <typename T, template<typename = T, typename...> class Queue_ = std::deque>
+class ShardedBlockingDequeue {
+public:
+	typedef T ValueType;
+	typedef BlockingDequeue<T, Queue_, std::condition_variable, DequeueLayout::compact> ShardType;
+
+	/**
+	 * @param capacity total capacity of all shards
+	 * @param shardCount number of shards, the number of hardware threads by default
+	 */
+	explicit ShardedBlockingDequeue(size_t capacity = SIZE_MAX, size_t shardCount = defaultShardCount(),
+	                                ShardOrder order = ShardOrder::per_producer)
+			: order(order), count(0), waiting_takers(0), is_closed(false) {
+		if (shardCount == 0) shardCount = 1;
+		size_t shardCapacity = capacity == SIZE_MAX ? SIZE_MAX : (capacity + shardCount - 1) / shardCount;
+		for (size_t i = 0; i < shardCount; ++i) shards.emplace_back(shardCapacity);
+	}
+
+	ShardedBlockingDequeue(const ShardedBlockingDequeue&) = delete;
+	ShardedBlockingDequeue& operator=(const ShardedBlockingDequeue&) = delete;
+
+	static size_t defaultShardCount() {
+		unsigned n = std::thread::hardware_concurrency();
+		return n != 0 ? n : 4;
+	}
+
+	/**
+	 * @brief Inserts the element into the shard of the calling thread, waiting if necessary for space in it. With
+	 * ShardOrder::none other shards are tried first.
+	 *
+	 * @return true if the element was added, false if the queue is closed
+	 */
+	template<typename Type>
+	bool put(Type && v) {
+		size_t shard = producerShard();
+		if (order == ShardOrder::none && offerAny(shard, v)) return true;
+		if (!shards[shard].queue.put(std::forward<Type>(v))) return false;
+		added();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts the element if it is possible to do so immediately, into the shard of the calling thread, or with
+	 * ShardOrder::none into any shard which has space.
+	 *
+	 * @return true if the element was added, false if the shards are full or the queue is closed
+	 */
+	template<typename Type>
+	bool offer(Type && v) {
+		size_t shard = producerShard();
+		if (order == ShardOrder::none) return offerAny(shard, v);
+		if (!shards[shard].queue.offer(std::forward<Type>(v))) return false;
+		added();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts all elements of the range, waiting if necessary for space. Elements go to the shard of the calling
+	 * thread, with ShardOrder::none they are spread over the shards which have space. If the queue is closed, the
+	 * remaining elements are not inserted.
+	 *
+	 * @param first, last forward iterators of the range of elements to add
+	 * @return the number of inserted elements, see BlockingDequeue::putAll
+	 */
+	template<typename Iterator>
+	size_t putAll(Iterator first, Iterator last) {
+		size_t shard = producerShard();
+		size_t total = 0;
+		while (first != last) {
+			total += offerAllFrom(shard, first, last);
+			if (first == last) break;
+			if (!shards[shard].queue.put(*first)) break;
+			added(1);
+			++total;
+			++first;
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Inserts elements of the range while it is possible to do so immediately, see offer.
+	 *
+	 * @param first, last forward iterators of the range of elements to add
+	 * @return the number of inserted elements, they are the first elements of the range
+	 */
+	template<typename Iterator>
+	size_t offerAll(Iterator first, Iterator last) {
+		return offerAllFrom(producerShard(), first, last);
+	}
+
+	/**
+	 * @brief Retrieves and removes an element, waiting if necessary until an element becomes available.
+	 *
+	 * @throw DequeueClosedException if the queue is closed and drained
+	 */
+	T take() {
+		T t;
+		if (pollStatus(t, -1) == DequeueStatus::closed) throw DequeueClosedException();
+		return t;
+	}
+
+	/**
+	 * @brief Same as BlockingDequeue::takeStatus.
+	 */
+	DequeueStatus takeStatus(T& out) {
+		return pollStatus(out, -1);
+	}
+
+	/**
+	 * @brief Retrieves and removes an element, waiting up to timeoutMs for it.
+	 *
+	 * @return the element, or defaultVal if the timeout elapses or the queue is closed and drained
+	 */
+	template<typename Type = T>
+	T poll(int timeoutMs, Type && defaultVal = Type(), bool * isOk = nullptr) {
+		T t;
+		bool isTaken = pollStatus(t, timeoutMs) == DequeueStatus::ok;
+		if (!isTaken) t = std::forward<Type>(defaultVal);
+		if (isOk) *isOk = isTaken;
+		return t;
+	}
+
+	/**
+	 * @brief Retrieves and removes an element into out, waiting up to timeoutMs, negative to wait without timeout.
+	 *
+	 * @return ok if out is set, timeout if the timeout elapsed, closed if the queue is closed and drained
+	 */
+	DequeueStatus pollStatus(T& out, int timeoutMs) {
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs < 0 ? 0 : timeoutMs);
+		for (;;) {
+			if (tryPoll(out)) return DequeueStatus::ok;
+			if (isDrained()) return DequeueStatus::closed;
+
+			std::unique_lock<std::mutex> lock(wait_mutex);
+			waiting_takers.fetch_add(1);
+			auto isReady = [this]() { return count.load() > 0 || is_closed.load(); };
+			bool isWoken = true;
+			if (timeoutMs < 0) wait_cond.wait(lock, isReady);
+			else isWoken = wait_cond.wait_until(lock, deadline, isReady);
+			waiting_takers.fetch_sub(1);
+			if (!isWoken) {
+				lock.unlock();
+				return tryPoll(out) ? DequeueStatus::ok : DequeueStatus::timeout;
+			}
+		}
+	}
+
+	/**
+	 * @brief Retrieves and removes an element of the first non-empty shard, starting from the offset of the calling
+	 * thread.
+	 *
+	 * @return true if out is set
+	 */
+	bool tryPoll(T& out) {
+		size_t start = consumerShard();
+		for (size_t i = 0; i < shards.size(); ++i) {
+			if (shards[(start + i) % shards.size()].queue.tryPoll(out)) {
+				count.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Returns the number of elements in all shards.
+	 */
+	size_t size() {
+		std::ptrdiff_t n = count.load();
+		return n > 0 ? static_cast<size_t>(n) : 0;
+	}
+
+	/**
+	 * @brief Removes up to maxCount available elements from the shards and adds them to other given queue.
+	 */
+	template<typename Appendable>
+	size_t drainTo(Appendable& other, size_t maxCount = SIZE_MAX) {
+		size_t start = consumerShard();
+		size_t drained = 0;
+		for (size_t i = 0; i < shards.size() && drained < maxCount; ++i) {
+			drained += shards[(start + i) % shards.size()].queue.drainTo(other, maxCount - drained);
+		}
+		count.fetch_sub(static_cast<std::ptrdiff_t>(drained));
+		return drained;
+	}
+
+	/**
+	 * @brief Closes all shards and wakes up all waiting threads, see BlockingDequeue::close.
+	 */
+	void close() {
+		is_closed.store(true);
+		for (Shard& shard : shards) shard.queue.close();
+		std::lock_guard<std::mutex> lock(wait_mutex);
+		wait_cond.notify_all();
+	}
+
+	bool isClosed() {
+		return is_closed.load();
+	}
+
+	/**
+	 * @brief Returns true if the queue is closed and all shards are empty.
+	 */
+	bool isDrained() {
+		if (!is_closed.load()) return false;
+		for (Shard& shard : shards) {
+			if (!shard.queue.isDrained()) return false;
+		}
+		return true;
+	}
+
+	size_t shardCount() const {
+		return shards.size();
+	}
+
+private:
+	/**
+	 * @brief Shard with padding, so locks of neighbour shards are on different cache lines.
+	 */
+	struct Shard {
+		explicit Shard(size_t capacity) : queue(capacity) { }
+
+		CacheLinePad<true> pad;
+		ShardType queue;
+	};
+
+	/**
+	 * @brief Offers v to the shards starting from start, v is moved only into the shard which accepts it.
+	 */
+	template<typename Type>
+	bool offerAny(size_t start, Type& v) {
+		for (size_t i = 0; i < shards.size(); ++i) {
+			if (shards[(start + i) % shards.size()].queue.offer(static_cast<Type&&>(v))) {
+				added();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Offers elements of the range to the shards starting from start and advances first past the inserted ones.
+	 * With ShardOrder::per_producer only the start shard is used.
+	 */
+	template<typename Iterator>
+	size_t offerAllFrom(size_t start, Iterator& first, Iterator last) {
+		size_t shardsToTry = order == ShardOrder::none ? shards.size() : 1;
+		size_t total = 0;
+		for (size_t i = 0; i < shardsToTry && first != last; ++i) {
+			size_t n = shards[(start + i) % shards.size()].queue.offerAll(first, last);
+			if (n == 0) continue;
+			std::advance(first, static_cast<typename std::iterator_traits<Iterator>::difference_type>(n));
+			added(n);
+			total += n;
+		}
+		return total;
+	}
+
+	/**
+	 * @brief Counts the added elements and wakes up consumers if some sleep. The element is published before it is
+	 * counted, so a consumer may take it first and the counter is below zero for a moment. The counter and
+	 * waiting_takers are sequentially consistent, so either the consumer sees the element or the producer sees the
+	 * consumer.
+	 */
+	void added(size_t n = 1) {
+		count.fetch_add(static_cast<std::ptrdiff_t>(n));
+		if (waiting_takers.load() == 0) return;
+		std::lock_guard<std::mutex> lock(wait_mutex);
+		if (n == 1) wait_cond.notify_one();
+		else wait_cond.notify_all();
+	}
+
+	size_t producerShard() {
+		static std::atomic<size_t> next(0);
+		static thread_local size_t producer = next.fetch_add(1, std::memory_order_relaxed);
+		static thread_local size_t rotation = 0;
+		if (order == ShardOrder::per_producer) return producer % shards.size();
+		return (producer + rotation++) % shards.size();
+	}
+
+	size_t consumerShard() {
+		static std::atomic<size_t> next(0);
+		static thread_local size_t consumer = next.fetch_add(1, std::memory_order_relaxed);
+		return consumer % shards.size();
+	}
+
+	std::deque<Shard> shards;
+	const ShardOrder order;
+	CacheLinePad<true> pad0;
+	std::atomic<std::ptrdiff_t> count;
+	CacheLinePad<true> pad1;
+	std::mutex wait_mutex;
+	std::condition_variable wait_cond;
+	std::atomic<size_t> waiting_takers;
+	std::atomic<bool> is_closed;
+};
+
+#endif // SHARDEDBLOCKINGDEQUEUE_H
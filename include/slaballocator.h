@@ -0,0 +1,250 @@
+#ifndef SLABALLOCATOR_H
+#define SLABALLOCATOR_H
+
+#include "platform.h"
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * @brief Per-thread cache of fixed-size blocks of SlabAllocator. Blocks are cut from chunks of BLOCKS_PER_CHUNK
+ * blocks and never move to another cache: a block freed by its owner thread goes to the local free list, a block freed
+ * by another thread is pushed to the remote list of its size class, and the owner takes the whole remote list with one
+ * exchange when the local list runs out.
+ *
+ * The cache lives while its thread runs or any of its blocks is allocated, so blocks may outlive the thread.
+ */
+class SlabCache {
+public:
+	static const size_t CLASSES = 5;
+	static const size_t MIN_BLOCK_SIZE = 32;
+	static const size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << (CLASSES - 1);
+	static const size_t BLOCKS_PER_CHUNK = 64;
+
+	/**
+	 * @brief Header before every block. The size of the header keeps blocks aligned as max_align_t.
+	 */
+	struct alignas(std::max_align_t) Header {
+		SlabCache* owner;
+		size_t size_class;
+	};
+
+	SlabCache() : refs(1) {
+		for (auto& sizeClass : classes) {
+			sizeClass.local = nullptr;
+			sizeClass.remote = nullptr;
+		}
+	}
+
+	SlabCache(const SlabCache&) = delete;
+	SlabCache& operator=(const SlabCache&) = delete;
+
+	~SlabCache() {
+		for (void* chunk : chunks) ::operator delete(chunk);
+	}
+
+	/**
+	 * @brief Returns size class of blocks which fit size bytes, or CLASSES if size is larger than MAX_BLOCK_SIZE.
+	 */
+	static size_t sizeClassOf(size_t size) {
+		size_t sizeClass = 0;
+		for (size_t blockSize = MIN_BLOCK_SIZE; blockSize < size; blockSize *= 2) ++sizeClass;
+		return sizeClass;
+	}
+
+	static size_t blockSizeOf(size_t sizeClass) {
+		return MIN_BLOCK_SIZE << sizeClass;
+	}
+
+	static Header* headerOf(void* p) {
+		return static_cast<Header*>(p) - 1;
+	}
+
+	/**
+	 * @brief Called by the owner thread only.
+	 */
+	void* allocate(size_t sizeClass) {
+		SizeClass& c = classes[sizeClass];
+		if (!c.local) c.local = c.remote.exchange(nullptr, std::memory_order_acquire);
+		if (!c.local) grow(sizeClass);
+		Block* block = c.local;
+		c.local = block->next;
+		refs.fetch_add(1, std::memory_order_relaxed);
+		return block;
+	}
+
+	/**
+	 * @brief Called by the owner thread only.
+	 */
+	void freeLocal(void* p, size_t sizeClass) {
+		Block* block = static_cast<Block*>(p);
+		block->next = classes[sizeClass].local;
+		classes[sizeClass].local = block;
+		release();
+	}
+
+	/**
+	 * @brief Called by any thread except the owner.
+	 */
+	void freeRemote(void* p, size_t sizeClass) {
+		Block* block = static_cast<Block*>(p);
+		std::atomic<Block*>& remote = classes[sizeClass].remote;
+		block->next = remote.load(std::memory_order_relaxed);
+		while (!remote.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) { }
+		release();
+	}
+
+	/**
+	 * @brief Drops one reference: an allocated block or the owner thread. The last one deletes the cache with all its
+	 * chunks.
+	 */
+	void release() {
+		if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+	}
+
+private:
+	struct Block {
+		Block* next;
+	};
+
+	struct SizeClass {
+		Block* local;
+		std::atomic<Block*> remote;
+		char pad[CACHE_LINE_SIZE - sizeof(Block*) - sizeof(std::atomic<Block*>)];
+	};
+
+	void grow(size_t sizeClass) {
+		size_t stride = sizeof(Header) + blockSizeOf(sizeClass);
+		char* chunk = static_cast<char*>(::operator new(stride * BLOCKS_PER_CHUNK));
+		chunks.push_back(chunk);
+		for (size_t i = BLOCKS_PER_CHUNK; i-- > 0;) {
+			Header* header = reinterpret_cast<Header*>(chunk + i * stride);
+			header->owner = this;
+			header->size_class = sizeClass;
+			Block* block = reinterpret_cast<Block*>(header + 1);
+			block->next = classes[sizeClass].local;
+			classes[sizeClass].local = block;
+		}
+	}
+
+	SizeClass classes[CLASSES];
+	std::atomic<size_t> refs;
+	std::vector<void*> chunks;
+};
+
+/**
+ * @brief Allocator of small blocks from per-thread slab caches, for objects which are allocated in one thread and
+ * freed in another, like tasks and future states. Allocation and local free touch only the cache of the calling
+ * thread, remote frees are returned to the owner in batches. Blocks larger than SlabCache::MAX_BLOCK_SIZE and
+ * allocations after the calling thread released its cache go to operator new.
+ *
+ * Allocator_ of FunctionWrapperTemplate, see also SlabStdAllocator.
+ */
+class SlabAllocator {
+public:
+	static void* allocate(size_t size) {
+		size_t sizeClass = SlabCache::sizeClassOf(size);
+		SlabCache* cache = sizeClass < SlabCache::CLASSES ? threadCache() : nullptr;
+		if (cache) return cache->allocate(sizeClass);
+
+		SlabCache::Header* header = static_cast<SlabCache::Header*>(::operator new(sizeof(SlabCache::Header) + size));
+		header->owner = nullptr;
+		header->size_class = SlabCache::CLASSES;
+		return header + 1;
+	}
+
+	static void deallocate(void* p) {
+		if (!p) return;
+		SlabCache::Header* header = SlabCache::headerOf(p);
+		SlabCache* owner = header->owner;
+		if (!owner) ::operator delete(header);
+		else if (owner == current()) owner->freeLocal(p, header->size_class);
+		else owner->freeRemote(p, header->size_class);
+	}
+
+private:
+	/**
+	 * @brief Owns the cache of the thread, releases it at thread exit.
+	 */
+	struct ThreadCache {
+		ThreadCache() {
+			current() = new SlabCache();
+		}
+
+		~ThreadCache() {
+			SlabCache* cache = current();
+			current() = nullptr;
+			isExited() = true;
+			cache->release();
+		}
+	};
+
+	static SlabCache*& current() {
+		static thread_local SlabCache* cache = nullptr;
+		return cache;
+	}
+
+	static bool& isExited() {
+		static thread_local bool is_exited = false;
+		return is_exited;
+	}
+
+	static SlabCache* threadCache() {
+		SlabCache* cache = current();
+		if (cache || isExited()) return cache;
+		static thread_local ThreadCache holder;
+		return current();
+	}
+};
+
+/**
+ * @brief Allocator of heap-allocated callables of FunctionWrapperTemplate which uses operator new, for the cases when
+ * slab caches are not wanted.
+ */
+class HeapAllocator {
+public:
+	static void* allocate(size_t size) {
+		return ::operator new(size);
+	}
+
+	static void deallocate(void* p) {
+		::operator delete(p);
+	}
+};
+
+/**
+ * @brief Standard allocator on top of SlabAllocator, for std::allocate_shared, std::promise and containers.
+ */
+template <typename T>
+class SlabStdAllocator {
+public:
+	typedef T value_type;
+
+	template<typename U>
+	struct rebind {
+		typedef SlabStdAllocator<U> other;
+	};
+
+	SlabStdAllocator() noexcept { }
+
+	template<typename U>
+	SlabStdAllocator(const SlabStdAllocator<U>&) noexcept { }
+
+	T* allocate(size_t n) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "SlabStdAllocator: over-aligned type");
+		return static_cast<T*>(SlabAllocator::allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* p, size_t) noexcept {
+		SlabAllocator::deallocate(p);
+	}
+
+	template<typename U>
+	bool operator==(const SlabStdAllocator<U>&) const noexcept { return true; }
+
+	template<typename U>
+	bool operator!=(const SlabStdAllocator<U>&) const noexcept { return false; }
+};
+
+#endif // SLABALLOCATOR_H
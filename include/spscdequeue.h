@@ -0,0 +1,303 @@
+#ifndef SPSCDEQUEUE_H
+#define SPSCDEQUEUE_H
+
+#include "platform.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Bounded queue for exactly one producer thread and one consumer thread. Put and take are wait-free when the
+ * ring is neither full nor empty: each side owns its index on a separate cache line and keeps a cached copy of the
+ * other side's index, so the shared line is read only when the cached value says the ring is full or empty. A blocked
+ * side spins for a short time and then parks on a condition variable.
+ *
+ * The interface repeats BlockingDequeue.
+ *
+ * @note Ring algorithm from: "Leslie Lamport. Specifying Concurrent Program Modules. ACM TOPLAS 1983"
+ */
+template <typename T>
+class SpscDequeue {
+public:
+	typedef T ValueType;
+
+	/**
+	 * @brief Constructor. Capacity is rounded up to the nearest power of two.
+	 */
+	explicit SpscDequeue(size_t capacity = 1024)
+			: mask(roundUpToPowerOf2(capacity) - 1), buffer(new Storage[mask + 1]),
+			  head(0), cached_tail(0), consumer_waiting(false), tail(0), cached_head(0), producer_waiting(false) { }
+
+	~SpscDequeue() {
+		size_t t = tail.load(std::memory_order_relaxed);
+		for (size_t h = head.load(std::memory_order_relaxed); h != t; ++h) at(h)->~T();
+		delete[] buffer;
+	}
+
+	SpscDequeue(const SpscDequeue&) = delete;
+	SpscDequeue& operator=(const SpscDequeue&) = delete;
+
+	/**
+	 * @brief Inserts the specified element into this queue, waiting if necessary for space to become available. May be
+	 * called by the producer thread only.
+	 *
+	 * @param v the element to add
+	 */
+	template<typename Type>
+	void put(Type && v) {
+		if (!tryPush(std::forward<Type>(v))) waitPush(std::forward<Type>(v), nullptr);
+		wakeConsumer();
+	}
+
+	/**
+	 * @brief Inserts the specified element at the end of this queue if it is possible to do so immediately without
+	 * exceeding the queue's capacity. May be called by the producer thread only.
+	 *
+	 * @param v the element to add
+	 * @return true if the element was added to this queue, else false
+	 */
+	template<typename Type>
+	bool offer(Type && v) {
+		if (!tryPush(std::forward<Type>(v))) return false;
+		wakeConsumer();
+		return true;
+	}
+
+	/**
+	 * @brief Inserts the specified element into this queue, waiting up to the specified wait time if necessary for
+	 * space to become available. May be called by the producer thread only.
+	 *
+	 * @param v the element to add
+	 * @param timeoutMs how long to wait before giving up, in milliseconds
+	 * @return true if successful, or false if the specified waiting time elapses before space is available
+	 */
+	template<typename Type>
+	bool offer(Type && v, int timeoutMs) {
+		if (!tryPush(std::forward<Type>(v))) {
+			Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+			if (!waitPush(std::forward<Type>(v), &deadline)) return false;
+		}
+		wakeConsumer();
+		return true;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue, waiting if necessary until an element becomes available. May
+	 * be called by the consumer thread only.
+	 *
+	 * @return the head of this queue
+	 */
+	T take() {
+		T t;
+		if (!tryPop(t)) waitPop(t, nullptr);
+		wakeProducer();
+		return t;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue, waiting up to the specified wait time if necessary for an
+	 * element to become available. May be called by the consumer thread only.
+	 *
+	 * @param timeoutMs how long to wait before giving up, in milliseconds
+	 * @param defaultVal value, which returns if the specified waiting time elapses before an element is available
+	 * @param isOk flag, which indicates result of method execution. It will be set to false if timeout, or true if
+	 * return value is retrieved value
+	 * @return the head of this queue, or defaultVal if the specified waiting time elapses before an element is available
+	 */
+	template<typename Type = T>
+	T poll(int timeoutMs, Type && defaultVal = Type(), bool * isOk = nullptr) {
+		T t;
+		bool isNotEmpty = tryPop(t);
+		if (!isNotEmpty) {
+			Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+			isNotEmpty = waitPop(t, &deadline);
+		}
+		if (isNotEmpty) wakeProducer();
+		else t = std::forward<Type>(defaultVal);
+		if (isOk) *isOk = isNotEmpty;
+		return t;
+	}
+
+	/**
+	 * @brief Retrieves and removes the head of this queue and return it if queue not empty, otherwise return defaultVal.
+	 * Do it immediately without waiting. May be called by the consumer thread only.
+	 *
+	 * @param defaultVal value, which returns if the queue is empty
+	 * @param isOk flag, which indicates result of method execution. It will be set to false if queue is empty, or true
+	 * if return value is retrieved value
+	 * @return the head of this queue, or defaultVal if the queue is empty
+	 */
+	template<typename Type = T>
+	T poll(Type && defaultVal = Type(), bool * isOk = nullptr) {
+		T t;
+		bool isNotEmpty = tryPop(t);
+		if (isNotEmpty) wakeProducer();
+		else t = std::forward<Type>(defaultVal);
+		if (isOk) *isOk = isNotEmpty;
+		return t;
+	}
+
+	/**
+	 * @brief Returns the number of elements that this queue can contain.
+	 */
+	size_t capacity() const {
+		return mask + 1;
+	}
+
+	/**
+	 * @brief Returns the number of additional elements that this queue can accept. The value is a snapshot and may be
+	 * stale by the moment it is returned.
+	 */
+	size_t remainingCapacity() const {
+		return capacity() - size();
+	}
+
+	/**
+	 * @brief Returns the number of elements in this collection. The value is a snapshot and may be stale by the
+	 * moment it is returned.
+	 */
+	size_t size() const {
+		size_t h = head.load(std::memory_order_acquire);
+		size_t t = tail.load(std::memory_order_acquire);
+		return t - h;
+	}
+
+	/**
+	 * @brief Removes all available elements from this queue and adds them to other given queue. May be called by the
+	 * consumer thread only.
+	 */
+	template<typename Appendable>
+	size_t drainTo(Appendable& other, size_t maxCount = SIZE_MAX) {
+		size_t h = head.load(std::memory_order_relaxed);
+		size_t t = tail.load(std::memory_order_acquire);
+		size_t count = t - h < maxCount ? t - h : maxCount;
+		for (size_t i = 0; i < count; ++i, ++h) {
+			other.push_back(std::move(*at(h)));
+			at(h)->~T();
+		}
+		if (count != 0) {
+			head.store(h, std::memory_order_release);
+			wakeProducer();
+		}
+		return count;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+	/**
+	 * Iterations of busy waiting before a blocked side parks on the condition variable.
+	 */
+	static const int SPIN_COUNT = 256;
+
+	T* at(size_t index) {
+		return reinterpret_cast<T*>(&buffer[index & mask]);
+	}
+
+	template<typename Type>
+	bool tryPush(Type && v) {
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - cached_head > mask) {
+			cached_head = head.load(std::memory_order_acquire);
+			if (t - cached_head > mask) return false;
+		}
+		new (at(t)) T(std::forward<Type>(v));
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(T& v) {
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == cached_tail) {
+			cached_tail = tail.load(std::memory_order_acquire);
+			if (h == cached_tail) return false;
+		}
+		v = std::move(*at(h));
+		at(h)->~T();
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename Type>
+	bool waitPush(Type && v, const Clock::time_point* deadline) {
+		for (int i = 0; i < SPIN_COUNT; ++i) {
+			cpuRelax();
+			if (tryPush(std::forward<Type>(v))) return true;
+		}
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		for (;;) {
+			producer_waiting.store(true);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (tryPush(std::forward<Type>(v))) break;
+			if (!deadline) {
+				not_full.wait(lock);
+			} else if (not_full.wait_until(lock, *deadline) == std::cv_status::timeout) {
+				producer_waiting.store(false);
+				return tryPush(std::forward<Type>(v));
+			}
+		}
+		producer_waiting.store(false);
+		return true;
+	}
+
+	bool waitPop(T& v, const Clock::time_point* deadline) {
+		for (int i = 0; i < SPIN_COUNT; ++i) {
+			cpuRelax();
+			if (tryPop(v)) return true;
+		}
+		std::unique_lock<std::mutex> lock(wait_mutex);
+		for (;;) {
+			consumer_waiting.store(true);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (tryPop(v)) break;
+			if (!deadline) {
+				not_empty.wait(lock);
+			} else if (not_empty.wait_until(lock, *deadline) == std::cv_status::timeout) {
+				consumer_waiting.store(false);
+				return tryPop(v);
+			}
+		}
+		consumer_waiting.store(false);
+		return true;
+	}
+
+	void wakeConsumer() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!consumer_waiting.load(std::memory_order_relaxed)) return;
+		{ std::lock_guard<std::mutex> lock(wait_mutex); }
+		not_empty.notify_one();
+	}
+
+	void wakeProducer() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!producer_waiting.load(std::memory_order_relaxed)) return;
+		{ std::lock_guard<std::mutex> lock(wait_mutex); }
+		not_full.notify_one();
+	}
+
+	const size_t mask;
+	Storage* const buffer;
+
+	// Consumer side
+	char pad0[CACHE_LINE_SIZE];
+	std::atomic<size_t> head;
+	size_t cached_tail;
+	std::atomic<bool> consumer_waiting;
+
+	// Producer side
+	char pad1[CACHE_LINE_SIZE];
+	std::atomic<size_t> tail;
+	size_t cached_head;
+	std::atomic<bool> producer_waiting;
+	char pad2[CACHE_LINE_SIZE];
+
+	std::mutex wait_mutex;
+	std::condition_variable not_full, not_empty;
+};
+
+#endif // SPSCDEQUEUE_H
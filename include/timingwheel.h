@@ -0,0 +1,187 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Element of TimingWheel. Deadline is measured in ticks of the wheel. Types stored in the wheel derive from it,
+ * so insert and remove do not allocate.
+ */
+struct TimerNode {
+	TimerNode() : prev(nullptr), next(nullptr), deadline(0), level(0), slot(0) { }
+
+	bool isLinked() const { return prev != nullptr; }
+
+	TimerNode* prev;
+	TimerNode* next;
+	uint64_t deadline;
+	unsigned char level;
+	unsigned char slot;
+};
+
+/**
+ * @brief Hierarchical timing wheel: LEVELS wheels of SLOTS slots, a slot of level l spans SLOTS^l ticks. Timers are
+ * placed into the lowest level which covers their remaining time and move down one level when the upper wheel turns,
+ * so insert and remove are O(1) and advance costs O(1) per tick plus the cost of moved timers. Deadlines farther than
+ * SLOTS^LEVELS ticks wait in the top level and are placed again when its slot comes.
+ *
+ * @note Algorithm from: "George Varghese, Tony Lauck. Hashed and Hierarchical Timing Wheels: Data Structures for the
+ * Efficient Implementation of a Timer Facility. SOSP 1987"
+ */
+class TimingWheel {
+public:
+	static const unsigned LEVELS = 4;
+	static const unsigned SLOT_BITS = 6;
+	static const unsigned SLOTS = 1u << SLOT_BITS;
+
+	/**
+	 * @brief Constructor.
+	 *
+	 * @param now the current tick, timers with deadline up to it are considered expired
+	 */
+	explicit TimingWheel(uint64_t now = 0) : current(now), count(0), occupied() {
+		for (unsigned level = 0; level < LEVELS; ++level) {
+			for (unsigned slot = 0; slot < SLOTS; ++slot) {
+				slots[level][slot].prev = slots[level][slot].next = &slots[level][slot];
+			}
+		}
+	}
+
+	TimingWheel(const TimingWheel&) = delete;
+	TimingWheel& operator=(const TimingWheel&) = delete;
+
+	/**
+	 * @brief Inserts not linked node. Deadlines which have already passed expire on the next tick.
+	 */
+	void insert(TimerNode* node) {
+		if (node->deadline <= current) node->deadline = current + 1;
+		place(node);
+		++count;
+	}
+
+	/**
+	 * @brief Removes linked node.
+	 */
+	void remove(TimerNode* node) {
+		unlink(node);
+		--count;
+	}
+
+	/**
+	 * @brief Moves the wheel to the tick now and calls onExpired(TimerNode*) for every timer with deadline up to it.
+	 * Expired nodes are removed before the call, so the callback may insert them again.
+	 */
+	template<typename Function>
+	void advance(uint64_t now, Function&& onExpired) {
+		if (count == 0 && current < now) current = now;
+		while (current < now) {
+			++current;
+			for (unsigned level = LEVELS - 1; level > 0; --level) {
+				if ((current & ((uint64_t(1) << (SLOT_BITS * level)) - 1)) == 0) cascade(level);
+			}
+			TimerNode& head = slots[0][current & (SLOTS - 1)];
+			while (head.next != &head) {
+				TimerNode* node = head.next;
+				remove(node);
+				onExpired(node);
+			}
+			if (count == 0) current = now;
+		}
+	}
+
+	/**
+	 * @brief Removes all timers and calls onRemoved(TimerNode*) for every of them.
+	 */
+	template<typename Function>
+	void clear(Function&& onRemoved) {
+		for (unsigned level = 0; level < LEVELS; ++level) {
+			for (unsigned slot = 0; slot < SLOTS; ++slot) {
+				TimerNode& head = slots[level][slot];
+				while (head.next != &head) {
+					TimerNode* node = head.next;
+					remove(node);
+					onRemoved(node);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns the tick when advance should be called next: the nearest deadline if it is in the lowest level,
+	 * or the next turn of the lowest level otherwise. Returns UINT64_MAX if the wheel is empty.
+	 */
+	uint64_t nextTick() const {
+		if (count == 0) return UINT64_MAX;
+		unsigned shift = static_cast<unsigned>((current + 1) & (SLOTS - 1));
+		uint64_t rotated = (occupied[0] >> shift) | (shift == 0 ? 0 : occupied[0] << (SLOTS - shift));
+		if (rotated != 0) return current + 1 + countTrailingZeros(rotated);
+		return (current | (SLOTS - 1)) + 1;
+	}
+
+	uint64_t now() const {
+		return current;
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+private:
+	void place(TimerNode* node) {
+		uint64_t delta = node->deadline - current;
+		uint64_t deadline = node->deadline;
+		unsigned level = 0;
+		while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) ++level;
+		if (level == LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * LEVELS))) {
+			deadline = current + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+		}
+		unsigned slot = static_cast<unsigned>((deadline >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+		TimerNode& head = slots[level][slot];
+		node->level = static_cast<unsigned char>(level);
+		node->slot = static_cast<unsigned char>(slot);
+		node->prev = head.prev;
+		node->next = &head;
+		head.prev->next = node;
+		head.prev = node;
+		occupied[level] |= uint64_t(1) << slot;
+	}
+
+	void unlink(TimerNode* node) {
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+		node->prev = node->next = nullptr;
+		TimerNode& head = slots[node->level][node->slot];
+		if (head.next == &head) occupied[node->level] &= ~(uint64_t(1) << node->slot);
+	}
+
+	/**
+	 * @brief Places timers of the current slot of the level again. Their remaining time is less than the slot span, so
+	 * they move to lower levels.
+	 */
+	void cascade(unsigned level) {
+		TimerNode& head = slots[level][(current >> (SLOT_BITS * level)) & (SLOTS - 1)];
+		while (head.next != &head) {
+			TimerNode* node = head.next;
+			unlink(node);
+			place(node);
+		}
+	}
+
+	static unsigned countTrailingZeros(uint64_t v) {
+		unsigned n = 0;
+		while ((v & 1) == 0) {
+			v >>= 1;
+			++n;
+		}
+		return n;
+	}
+
+	uint64_t current;
+	size_t count;
+	uint64_t occupied[LEVELS];
+	TimerNode slots[LEVELS][SLOTS];
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,126 @@
+#ifndef WORKSTEALINGDEQUE_H
+#define WORKSTEALINGDEQUE_H
+
+#include "platform.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Unbounded single-owner double-ended queue for work stealing. The owner thread pushes and pops elements at the
+ * bottom (LIFO), any other thread may steal elements from the top (FIFO). Elements must be trivially copyable, usually
+ * they are pointers to tasks.
+ *
+ * @note Algorithm from: "Nhat Minh Lê, Antoniu Pop, Albert Cohen, Francesco Zappa Nardelli. Correct and Efficient
+ * Work-Stealing for Weak Memory Models. PPoPP 2013"
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+	/**
+	 * @brief Constructor. Capacity is rounded up to the nearest power of two and grows on demand.
+	 */
+	explicit WorkStealingDeque(size_t capacity = 256) : top(0), bottom(0), array(new Array(roundUpToPowerOf2(capacity))) { }
+
+	~WorkStealingDeque() {
+		delete array.load(std::memory_order_relaxed);
+		for (Array* a : retired) delete a;
+	}
+
+	WorkStealingDeque(const WorkStealingDeque&) = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+	/**
+	 * @brief Inserts element at the bottom. May be called by the owner thread only.
+	 */
+	void push(T v) {
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		Array* a = array.load(std::memory_order_relaxed);
+		if (b - t > static_cast<int64_t>(a->mask)) {
+			a = grow(a, b, t);
+		}
+		a->put(b, v);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Retrieves and removes the bottom element. May be called by the owner thread only.
+	 *
+	 * @return true if element retrieved, or false if deque is empty
+	 */
+	bool pop(T& v) {
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Array* a = array.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+		v = a->get(b);
+		if (t == b) {
+			bool isWon = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return isWon;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Retrieves and removes the top element. May be called by any thread.
+	 *
+	 * @return true if element retrieved, or false if deque is empty or the race for the element is lost
+	 */
+	bool steal(T& v) {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if (t >= b) return false;
+		Array* a = array.load(std::memory_order_acquire);
+		T x = a->get(t);
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return false;
+		v = x;
+		return true;
+	}
+
+	/**
+	 * @brief Returns the number of elements. The value is a snapshot and may be stale by the moment it is returned.
+	 */
+	size_t size() const {
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_relaxed);
+		return b > t ? static_cast<size_t>(b - t) : 0;
+	}
+
+private:
+	struct Array {
+		const size_t mask;
+		std::atomic<T>* const buffer;
+
+		explicit Array(size_t capacity) : mask(capacity - 1), buffer(new std::atomic<T>[capacity]) { }
+		~Array() { delete[] buffer; }
+
+		T get(int64_t i) const { return buffer[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed); }
+		void put(int64_t i, T v) { buffer[static_cast<size_t>(i) & mask].store(v, std::memory_order_relaxed); }
+	};
+
+	Array* grow(Array* a, int64_t b, int64_t t) {
+		Array* bigger = new Array((a->mask + 1) << 1);
+		for (int64_t i = t; i < b; ++i) bigger->put(i, a->get(i));
+		// Thieves may still read the old array, so it lives until the deque is destroyed
+		retired.push_back(a);
+		array.store(bigger, std::memory_order_release);
+		return bigger;
+	}
+
+	std::atomic<int64_t> top;
+	char pad0[CACHE_LINE_SIZE - sizeof(std::atomic<int64_t>)];
+	std::atomic<int64_t> bottom;
+	std::atomic<Array*> array;
+	std::vector<Array*> retired;
+};
+
+#endif // WORKSTEALINGDEQUE_H
@@ -0,0 +1,242 @@
+#ifndef WORKSTEALINGEXECUTOR_H
+#define WORKSTEALINGEXECUTOR_H
+
+#include "executor.h"
+#include "slaballocator.h"
+#include "workstealingdeque.h"
+#include <condition_variable>
+#include <mutex>
+#include <new>
+
+/**
+ * @brief Thread pool where every worker owns a work-stealing deque. Tasks submitted from a worker thread go to its own
+ * deque and are executed in LIFO order, tasks submitted from other threads go to the shared injection queue. Idle
+ * workers take tasks from the injection queue or steal in FIFO order from the other workers.
+ *
+ * The interface and the shutdown semantics repeat ThreadPoolExecutorTemplate: after shutdown, shutdownNow and in the
+ * destructor workers run the queued tasks before they stop. Tasks are allocated with SlabAllocator, the deques hold
+ * pointers to them.
+ */
+template <typename Thread_ = std::thread>
+class WorkStealingThreadPoolExecutorTemplate {
+protected:
+	enum thread_command {
+		run,
+		shutdown_c,
+		shutdown_now
+	};
+
+public:
+	explicit WorkStealingThreadPoolExecutorTemplate(size_t corePoolSize = 1)
+			: thread_command_(thread_command::run), queued_tasks(0), idle_workers(0), live_workers(0) {
+		makePool(corePoolSize);
+	}
+
+	virtual ~WorkStealingThreadPoolExecutorTemplate() {
+		shutdownNow();
+		joinPool();
+		// Tasks pushed while the workers were stopping
+		FunctionWrapper* task;
+		for (Worker* worker : workers) {
+			while (worker->deque.pop(task)) deleteTask(task);
+			delete worker;
+		}
+		for (FunctionWrapper* t : injection_queue) deleteTask(t);
+		for (Thread_* thread : threadPool) delete thread;
+	}
+
+	template<typename FunctionType>
+	std::future<typename std::result_of<FunctionType()>::type> submit(FunctionType&& callable) {
+		typedef typename std::result_of<FunctionType()>::type ResultType;
+
+		if (thread_command_ == thread_command::run) {
+			SubmitTask<ResultType, typename std::decay<FunctionType>::type> callable_task(
+					std::forward<FunctionType>(callable));
+			auto future = callable_task.getFuture();
+			push(newTask(std::move(callable_task)));
+			return future;
+		} else {
+			return std::future<ResultType>();
+		}
+	}
+
+	template<typename FunctionType>
+	void execute(FunctionType&& runnable) {
+		if (thread_command_ == thread_command::run) {
+			push(newTask(std::forward<FunctionType>(runnable)));
+		}
+	}
+
+	void shutdown() {
+		setCommand(thread_command::shutdown_c);
+	}
+
+	void shutdownNow() {
+		setCommand(thread_command::shutdown_now);
+	}
+
+	bool isShutdown() const {
+		return thread_command_ != thread_command::run;
+	}
+
+	bool awaitTermination(int timeoutMs) {
+		{
+			std::unique_lock<std::mutex> lock(park_mutex);
+			bool isTerminated = termination_cond.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&]() {
+				return live_workers == 0;
+			});
+			if (!isTerminated) return false;
+		}
+		joinPool();
+		return true;
+	}
+
+protected:
+	struct Worker {
+		WorkStealingDeque<FunctionWrapper*> deque;
+		WorkStealingThreadPoolExecutorTemplate* owner;
+		size_t index;
+		uint32_t seed;
+		char pad[CACHE_LINE_SIZE];
+
+		Worker(WorkStealingThreadPoolExecutorTemplate* owner, size_t index)
+				: owner(owner), index(index), seed(static_cast<uint32_t>(index) * 2654435761u + 1) { }
+	};
+
+	std::atomic<thread_command> thread_command_;
+	std::vector<Worker*> workers;
+	std::vector<Thread_*> threadPool;
+
+	std::mutex injection_mutex;
+	SlabDeque<FunctionWrapper*> injection_queue;
+
+	std::atomic<int64_t> queued_tasks;
+	std::atomic<size_t> idle_workers;
+	std::mutex park_mutex;
+	std::condition_variable park_cond, termination_cond;
+	size_t live_workers;
+	std::once_flag join_flag;
+
+	template<typename Function>
+	WorkStealingThreadPoolExecutorTemplate(size_t corePoolSize, Function&& onBeforeStart)
+			: thread_command_(thread_command::run), queued_tasks(0), idle_workers(0), live_workers(0) {
+		makePool(corePoolSize, std::forward<Function>(onBeforeStart));
+	}
+
+	static Worker*& currentWorker() {
+		static thread_local Worker* worker = nullptr;
+		return worker;
+	}
+
+	void makePool(size_t corePoolSize, std::function<void(Thread_*)>&& onBeforeStart = [](Thread_*){}) {
+		for (size_t i = 0; i < corePoolSize; ++i) workers.push_back(new Worker(this, i));
+		live_workers = corePoolSize;
+		for (size_t i = 0; i < corePoolSize; ++i) {
+			Worker* worker = workers[i];
+			auto* thread = new Thread_([this, worker](){ workerLoop(worker); });
+			threadPool.push_back(thread);
+			onBeforeStart(thread);
+		}
+	}
+
+	template<typename FunctionType>
+	static FunctionWrapper* newTask(FunctionType&& f) {
+		void* block = SlabAllocator::allocate(sizeof(FunctionWrapper));
+		try {
+			return new (block) FunctionWrapper(std::forward<FunctionType>(f));
+		} catch (...) {
+			SlabAllocator::deallocate(block);
+			throw;
+		}
+	}
+
+	static void deleteTask(FunctionWrapper* task) {
+		task->~FunctionWrapper();
+		SlabAllocator::deallocate(task);
+	}
+
+	void push(FunctionWrapper* task) {
+		Worker* worker = currentWorker();
+		if (worker != nullptr && worker->owner == this) {
+			worker->deque.push(task);
+		} else {
+			std::lock_guard<std::mutex> lock(injection_mutex);
+			injection_queue.push_back(task);
+		}
+		queued_tasks.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (idle_workers.load(std::memory_order_relaxed) != 0) {
+			{ std::lock_guard<std::mutex> lock(park_mutex); }
+			park_cond.notify_one();
+		}
+	}
+
+	FunctionWrapper* findTask(Worker* worker) {
+		FunctionWrapper* task = nullptr;
+		if (worker->deque.pop(task)) return task;
+		{
+			std::lock_guard<std::mutex> lock(injection_mutex);
+			if (!injection_queue.empty()) {
+				task = injection_queue.front();
+				injection_queue.pop_front();
+				return task;
+			}
+		}
+		size_t count = workers.size();
+		if (count < 2) return nullptr;
+		// xorshift random victim, then round robin over the rest
+		worker->seed ^= worker->seed << 13;
+		worker->seed ^= worker->seed >> 17;
+		worker->seed ^= worker->seed << 5;
+		size_t start = worker->seed % count;
+		for (size_t i = 0; i < count; ++i) {
+			Worker* victim = workers[(start + i) % count];
+			if (victim != worker && victim->deque.steal(task)) return task;
+		}
+		return nullptr;
+	}
+
+	void workerLoop(Worker* worker) {
+		currentWorker() = worker;
+		for (;;) {
+			FunctionWrapper* task = findTask(worker);
+			if (task != nullptr) {
+				queued_tasks.fetch_sub(1);
+				(*task)();
+				deleteTask(task);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(park_mutex);
+			idle_workers.fetch_add(1);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			while (queued_tasks.load(std::memory_order_relaxed) == 0 && thread_command_ == thread_command::run) {
+				park_cond.wait(lock);
+			}
+			idle_workers.fetch_sub(1);
+			if (thread_command_ != thread_command::run && queued_tasks.load() == 0) break;
+		}
+		currentWorker() = nullptr;
+
+		std::lock_guard<std::mutex> lock(park_mutex);
+		if (--live_workers == 0) termination_cond.notify_all();
+	}
+
+	void setCommand(thread_command command) {
+		{
+			std::lock_guard<std::mutex> lock(park_mutex);
+			if (command > thread_command_) thread_command_ = command;
+		}
+		park_cond.notify_all();
+	}
+
+	void joinPool() {
+		std::call_once(join_flag, [this]() {
+			for (Thread_* thread : threadPool) thread->join();
+		});
+	}
+};
+
+typedef WorkStealingThreadPoolExecutorTemplate<> WorkStealingThreadPoolExecutor;
+
+#endif // WORKSTEALINGEXECUTOR_H
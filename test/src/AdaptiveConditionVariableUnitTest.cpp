@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "adaptiveconditionvariable.h"
+#include "blockingdequeue.h"
+
+#include <deque>
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+typedef AdaptiveConditionVariable<100, 4> SmallBudgetConditionVariable;
+
+TEST(AdaptiveConditionVariableUnitTest, wait_is_return_at_once_when_predicate_true) {
+	SmallBudgetConditionVariable condVar;
+	std::mutex mutex;
+	std::unique_lock<std::mutex> lock(mutex);
+	condVar.wait(lock, []() { return true; });
+	AdaptiveWaitStats stats = condVar.stats();
+	ASSERT_EQ(stats.spinWakeups + stats.yieldWakeups + stats.parkWakeups, 0);
+}
+
+TEST(AdaptiveConditionVariableUnitTest, wait_for_is_false_when_timeout) {
+	SmallBudgetConditionVariable condVar;
+	std::mutex mutex;
+	std::unique_lock<std::mutex> lock(mutex);
+	auto start_time = steady_clock::now();
+	ASSERT_FALSE(condVar.wait_for(lock, milliseconds(WAIT_THREAD_TIME_MS), []() { return false; }));
+	ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS);
+	ASSERT_TRUE(lock.owns_lock());
+	ASSERT_EQ(condVar.stats().timeouts, 1);
+}
+
+TEST(AdaptiveConditionVariableUnitTest, wait_is_park_when_budget_exhausted) {
+	SmallBudgetConditionVariable condVar;
+	std::mutex mutex;
+	bool isReady = false;
+	std::thread notifier([&]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isReady = true;
+		}
+		condVar.notify_one();
+	});
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condVar.wait(lock, [&]() { return isReady; });
+	}
+	notifier.join();
+	ASSERT_EQ(condVar.stats().parkWakeups, 1);
+}
+
+TEST(AdaptiveConditionVariableUnitTest, wait_is_wake_in_spin_phase) {
+	AdaptiveConditionVariable<1000000000, 0> condVar;
+	std::mutex mutex;
+	std::atomic_bool isWaiting(false);
+	bool isReady = false;
+	std::thread notifier([&]() {
+		while (!isWaiting) this_thread::yield();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isReady = true;
+		}
+		condVar.notify_one();
+	});
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		isWaiting = true;
+		condVar.wait(lock, [&]() { return isReady; });
+	}
+	notifier.join();
+	ASSERT_EQ(condVar.stats().spinWakeups, 1);
+}
+
+TEST(AdaptiveConditionVariableUnitTest, blockingDequeue_is_transfer_elements) {
+	const int count = 10000;
+	BlockingDequeue<int, std::deque, SmallBudgetConditionVariable> dequeue(8);
+	std::thread producer([&]() {
+		for (int i = 0; i < count; ++i) dequeue.put(i);
+	});
+	int expected = 0;
+	for (; expected < count; ++expected) {
+		if (dequeue.take() != expected) break;
+	}
+	producer.join();
+	ASSERT_EQ(expected, count);
+}
@@ -0,0 +1,217 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "blockingdequeue.h"
+
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+TEST(BlockingDequeueIntegrationTest, offerAll_is_insert_until_capacity_reach) {
+	BlockingDequeue<int> dequeue(3);
+	std::vector<int> values = {1, 2, 3, 4, 5};
+	ASSERT_EQ(dequeue.offerAll(values.begin(), values.end()), 3);
+	ASSERT_EQ(dequeue.size(), 3);
+	ASSERT_EQ(dequeue.take(), 1);
+}
+
+TEST(BlockingDequeueIntegrationTest, putAll_is_wait_for_space) {
+	BlockingDequeue<int> dequeue(2);
+	std::vector<int> values = {1, 2, 3, 4, 5};
+	std::vector<int> taken;
+	std::thread consumer([&]() {
+		for (size_t i = 0; i < values.size(); ++i) taken.push_back(dequeue.take());
+	});
+	dequeue.putAll(values.begin(), values.end());
+	consumer.join();
+	ASSERT_EQ(taken, values);
+}
+
+TEST(BlockingDequeueIntegrationTest, takeBatch_is_limited_by_maxCount) {
+	BlockingDequeue<int> dequeue;
+	std::vector<int> values = {1, 2, 3, 4, 5};
+	dequeue.putAll(values.begin(), values.end());
+	std::vector<int> batch;
+	ASSERT_EQ(dequeue.takeBatch(batch, 3, 0), 3);
+	ASSERT_EQ(batch, std::vector<int>({1, 2, 3}));
+	ASSERT_EQ(dequeue.size(), 2);
+}
+
+TEST(BlockingDequeueIntegrationTest, takeBatch_is_zero_when_timeout) {
+	BlockingDequeue<int> dequeue;
+	std::vector<int> batch;
+	auto start_time = steady_clock::now();
+	ASSERT_EQ(dequeue.takeBatch(batch, 3, WAIT_THREAD_TIME_MS), 0);
+	ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS);
+	ASSERT_TRUE(batch.empty());
+}
+
+TEST(BlockingDequeueIntegrationTest, takeBatch_is_wake_on_putAll) {
+	BlockingDequeue<int> dequeue;
+	std::vector<int> batch;
+	std::thread producer([&]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		std::vector<int> values = {1, 2, 3};
+		dequeue.putAll(values.begin(), values.end());
+	});
+	size_t count = dequeue.takeBatch(batch, 10, 10 * WAIT_THREAD_TIME_MS);
+	producer.join();
+	ASSERT_GE(count, 1);
+	ASSERT_EQ(batch.front(), 1);
+}
+
+TEST(BlockingDequeueIntegrationTest, drainTo_is_wake_blocked_put) {
+	BlockingDequeue<int> dequeue(1);
+	dequeue.put(1);
+	std::thread producer([&]() { dequeue.put(2); });
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	std::vector<int> drained;
+	ASSERT_EQ(dequeue.drainTo(drained), 1);
+	producer.join();
+	ASSERT_EQ(dequeue.take(), 2);
+}
+
+TEST(BlockingDequeueIntegrationTest, putAll_is_wake_all_consumers) {
+	const int consumerCount = 4;
+	BlockingDequeue<int> dequeue;
+	std::atomic_int takenCount(0);
+	std::vector<std::thread> consumers;
+	for (int i = 0; i < consumerCount; ++i) {
+		consumers.emplace_back([&]() {
+			dequeue.take();
+			takenCount++;
+		});
+	}
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	std::vector<int> values(consumerCount, 1);
+	dequeue.putAll(values.begin(), values.end());
+	for (auto& consumer : consumers) consumer.join();
+	ASSERT_EQ(takenCount, consumerCount);
+}
+
+TEST(BlockingDequeueIntegrationTest, pollAny_is_prefer_lower_index) {
+	BlockingDequeue<int> control, data;
+	data.put(2);
+	control.put(1);
+	PollAnyResult<int> result = pollAny(0, control, data);
+	ASSERT_EQ(result.index, 0);
+	ASSERT_EQ(result.value, 1);
+	result = pollAny(0, control, data);
+	ASSERT_EQ(result.index, 1);
+	ASSERT_EQ(result.value, 2);
+	ASSERT_FALSE(pollAny(0, control, data));
+}
+
+TEST(BlockingDequeueIntegrationTest, pollAny_is_timeout_on_empty_queues) {
+	BlockingDequeue<int> first, second;
+	auto start = steady_clock::now();
+	PollAnyResult<int> result = pollAny(WAIT_THREAD_TIME_MS, first, second);
+	ASSERT_EQ(result.index, -1);
+	ASSERT_GE(steady_clock::now() - start, milliseconds(WAIT_THREAD_TIME_MS));
+}
+
+TEST(BlockingDequeueIntegrationTest, pollAny_is_wake_on_put_to_any_queue) {
+	BlockingDequeue<int> first, second, third;
+	std::vector<BlockingDequeue<int>*> queues = {&first, &second, &third};
+	std::thread producer([&]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		third.put(3);
+	});
+	PollAnyResult<int> result = pollAny(queues, -1);
+	producer.join();
+	ASSERT_EQ(result.index, 2);
+	ASSERT_EQ(result.value, 3);
+
+	// Registration is removed, later puts do not touch the selector
+	first.put(1);
+	ASSERT_EQ(first.take(), 1);
+}
+
+TEST(BlockingDequeueIntegrationTest, pollAny_is_share_elements_between_consumers) {
+	const int count = 10000;
+	BlockingDequeue<int> first, second;
+	std::atomic_int sum(0), taken(0);
+	std::vector<std::thread> consumers;
+	for (int i = 0; i < 3; ++i) {
+		consumers.emplace_back([&]() {
+			while (taken.load() < count) {
+				PollAnyResult<int> result = pollAny(1, first, second);
+				if (!result) continue;
+				sum += result.value;
+				taken++;
+			}
+		});
+	}
+	for (int i = 0; i < count; ++i) (i % 2 ? first : second).put(1);
+	for (auto& consumer : consumers) consumer.join();
+	ASSERT_EQ(sum.load(), count);
+}
+
+TEST(BlockingDequeueIntegrationTest, close_is_wake_waiting_consumers) {
+	BlockingDequeue<int> dequeue;
+	std::vector<std::thread> consumers;
+	std::atomic_int closedCount(0);
+	for (int i = 0; i < 3; ++i) {
+		consumers.emplace_back([&]() {
+			int value;
+			if (dequeue.takeStatus(value) == DequeueStatus::closed) closedCount++;
+		});
+	}
+	consumers.emplace_back([&]() {
+		try {
+			dequeue.take();
+		} catch (const DequeueClosedException&) {
+			closedCount++;
+		}
+	});
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	dequeue.close();
+	for (auto& consumer : consumers) consumer.join();
+	ASSERT_EQ(closedCount.load(), 4);
+}
+
+TEST(BlockingDequeueIntegrationTest, close_is_drain_remaining_and_reject_puts) {
+	BlockingDequeue<int> dequeue(2);
+	dequeue.put(1);
+	dequeue.put(2);
+	std::thread producer([&]() { ASSERT_FALSE(dequeue.put(3)); });
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	dequeue.close();
+	producer.join();
+
+	ASSERT_FALSE(dequeue.offer(4));
+	int value = 0;
+	ASSERT_EQ(dequeue.pollStatus(value, 0), DequeueStatus::ok);
+	ASSERT_EQ(value, 1);
+	ASSERT_EQ(dequeue.takeStatus(value), DequeueStatus::ok);
+	ASSERT_EQ(value, 2);
+	ASSERT_EQ(dequeue.pollStatus(value, 1000), DequeueStatus::closed);
+	ASSERT_TRUE(dequeue.isDrained());
+}
+
+TEST(BlockingDequeueIntegrationTest, poll_status_is_timeout_when_empty) {
+	BlockingDequeue<int> dequeue;
+	int value = 0;
+	ASSERT_EQ(dequeue.pollStatus(value, 1), DequeueStatus::timeout);
+}
+
+TEST(BlockingDequeueIntegrationTest, poll_of_two_lvalues_is_return_default_value) {
+	BlockingDequeue<int> dequeue;
+	int timeoutMs = 1;
+	int defaultVal = 42;
+	ASSERT_EQ(dequeue.poll(timeoutMs, defaultVal), 42);
+	ASSERT_EQ(timeoutMs, 1);
+}
+
+TEST(BlockingDequeueIntegrationTest, pollAny_is_return_when_all_closed) {
+	BlockingDequeue<int> first, second;
+	first.close();
+	std::thread closer([&]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		second.close();
+	});
+	PollAnyResult<int> result = pollAny(-1, first, second);
+	closer.join();
+	ASSERT_EQ(result.index, -1);
+}
@@ -19,11 +19,12 @@ public:
     bool isTrueCondition = false;
     int timeout = -1;
 
-	MOCK_METHOD1(wait, void(std::mutex&));
-	MOCK_METHOD2(wait, void(std::mutex&, const std::function<bool()>&));
-	MOCK_METHOD2(wait_for, bool(std::mutex&, int));
-	MOCK_METHOD3(wait_for, bool(std::mutex&, int, const std::function<bool()>&));
+	MOCK_METHOD1(wait, void(std::unique_lock<std::mutex>&));
+	MOCK_METHOD2(wait, void(std::unique_lock<std::mutex>&, const std::function<bool()>&));
+	MOCK_METHOD2(wait_for, bool(std::unique_lock<std::mutex>&, std::chrono::milliseconds));
+	MOCK_METHOD3(wait_for, bool(std::unique_lock<std::mutex>&, std::chrono::milliseconds, const std::function<bool()>&));
 	MOCK_METHOD0(notify_one, void());
+	MOCK_METHOD0(notify_all, void());
 };
 
 struct QueueElement {
@@ -87,8 +88,8 @@ public:
 	         typename std::enable_if<!std::is_arithmetic<Iterable>::value, int>::type = 0>
 	explicit BlockingDequeuePrepare(const Iterable& other): SuperClass(other) { }
 
-	MockConditionVar* getCondVarAdd() { return this->cond_var_add; }
-	MockConditionVar* getCondVarRem() { return this->cond_var_rem; }
+	MockConditionVar* getCondVarAdd() { return &this->cond_var_add; }
+	MockConditionVar* getCondVarRem() { return &this->cond_var_rem; }
 	MockDeque<QueueElement>& getQueue() { return this->data_queue; }
 	size_t getMaxSize() { return max_size; }
 };
@@ -131,7 +132,7 @@ TEST_F(BlockingDequeueUnitTest, construct_from_iterable) {
 void BlockingDequeueUnitTest::put_is_wait_predicate(bool isCapacityReach) {
 	std::function<bool()> conditionVarPredicate;
 	EXPECT_CALL(*dequeue.getCondVarRem(), wait(_, _))
-			.WillOnce([&](std::mutex& m, const std::function<bool()>& predicate){ conditionVarPredicate = predicate; });
+			.WillOnce([&](std::unique_lock<std::mutex>& m, const std::function<bool()>& predicate){ conditionVarPredicate = predicate; });
 	dequeue.put(element);
 
 	ON_CALL(dequeue.getQueue(), size)
@@ -225,8 +226,8 @@ TEST_F(BlockingDequeueUnitTest, offer1_is_not_notify_about_insert_when_capacity_
 
 void BlockingDequeueUnitTest::offer2_is_wait_predicate(bool isCapacityReach) {
 	std::function<bool()> conditionVarPredicate;
-	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(timeout), _))
-			.WillOnce([&](std::mutex& m, int timeout_, const std::function<bool()>& predicate) {
+	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(std::chrono::milliseconds(timeout)), _))
+			.WillOnce([&](std::unique_lock<std::mutex>& m, std::chrono::milliseconds timeout_, const std::function<bool()>& predicate) {
 				conditionVarPredicate = predicate;
 				return isCapacityReach;
 			});
@@ -246,7 +247,7 @@ TEST_F(BlockingDequeueUnitTest, offer2_is_wait_predicate_false_when_capacity_rea
 }
 
 TEST_F(BlockingDequeueUnitTest, offer2_is_insert_by_copy) {
-	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(timeout), _))
+	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(std::chrono::milliseconds(timeout)), _))
 			.WillOnce(Return(true));
 	EXPECT_CALL(dequeue.getQueue(), push_back( Eq(element) ))
 			.WillOnce(Return());
@@ -255,7 +256,7 @@ TEST_F(BlockingDequeueUnitTest, offer2_is_insert_by_copy) {
 
 TEST_F(BlockingDequeueUnitTest, offer2_is_insert_by_move) {
 	QueueElement copyElement = element;
-	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(timeout), _))
+	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(std::chrono::milliseconds(timeout)), _))
 			.WillOnce(Return(true));
 	EXPECT_CALL(dequeue.getQueue(), push_back_rval( Eq(element) ))
 			.WillOnce(Return());
@@ -263,7 +264,7 @@ TEST_F(BlockingDequeueUnitTest, offer2_is_insert_by_move) {
 }
 
 TEST_F(BlockingDequeueUnitTest, offer2_is_not_insert_when_timeout) {
-	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(timeout), _))
+	EXPECT_CALL(*dequeue.getCondVarRem(), wait_for(_, Eq(std::chrono::milliseconds(timeout)), _))
 			.WillOnce(Return(false));
 	EXPECT_CALL(dequeue.getQueue(), push_back(_))
 			.Times(0);
@@ -301,7 +302,7 @@ TEST_F(BlockingDequeueUnitTest, offer2_is_not_notify_about_insert_when_timeout)
 void BlockingDequeueUnitTest::take_is_wait_predicate(bool isEmpty) {
 	std::function<bool()> conditionVarPredicate;
 	EXPECT_CALL(*dequeue.getCondVarAdd(), wait(_, _))
-			.WillOnce([&](std::mutex& m, const std::function<bool()>& predicate) { conditionVarPredicate = predicate; });
+			.WillOnce([&](std::unique_lock<std::mutex>& m, const std::function<bool()>& predicate) { conditionVarPredicate = predicate; });
 	dequeue.take();
 
 	ON_CALL(dequeue.getQueue(), size)
@@ -508,3 +509,27 @@ TEST(BlockingDequeueUnitTest, drainTo_is_ret_eq_to_maxCount) {
     ASSERT_EQ(blockingDequeue.drainTo(deque, refDeque.size() - 1), refDeque.size() - 1);
 }
 */
+
+template <DequeueLayout Layout_>
+struct LayoutProbe: public BlockingDequeue<int, std::deque, std::condition_variable, Layout_> {
+	static size_t distance(const void* from, const void* to) {
+		return static_cast<size_t>(static_cast<const char*>(to) - static_cast<const char*>(from));
+	}
+
+	size_t consumerOffset() const {
+		return distance(&this->max_size, &this->cond_var_add);
+	}
+
+	size_t producerOffset() const {
+		return distance(&this->waiting_takers, &this->cond_var_rem);
+	}
+};
+
+TEST_F(BlockingDequeueUnitTest, padded_layout_is_separate_wait_state) {
+	LayoutProbe<DequeueLayout::padded> padded;
+	ASSERT_GT(padded.consumerOffset(), CACHE_LINE_SIZE);
+	ASSERT_GT(padded.producerOffset(), CACHE_LINE_SIZE);
+
+	LayoutProbe<DequeueLayout::compact> compact;
+	ASSERT_LT(compact.consumerOffset(), CACHE_LINE_SIZE);
+}
@@ -0,0 +1,133 @@
+#ifdef CONCURRENT_COROUTINES
+
+#include "gtest/gtest.h"
+#include "blockingdequeue.h"
+#include "executor.h"
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static DetachedTask hopTo(ThreadPoolExecutor& executor, promise<thread::id>& result) {
+	co_await executor.schedule();
+	result.set_value(this_thread::get_id());
+}
+
+TEST(CoroutineUnitTest, schedule_is_resume_on_worker) {
+	ThreadPoolExecutor executor(1);
+	promise<thread::id> result;
+	hopTo(executor, result);
+	ASSERT_NE(result.get_future().get(), this_thread::get_id());
+}
+
+static DetachedTask consume(BlockingDequeue<int>& queue, ThreadPoolExecutor& executor, atomic<int>& sum,
+                            atomic<int>& done) {
+	for (;;) {
+		int value = co_await queue.asyncTake(executor);
+		if (value < 0) break;
+		sum.fetch_add(value);
+	}
+	done.fetch_add(1);
+}
+
+TEST(CoroutineUnitTest, asyncTake_is_share_few_threads_between_many_consumers) {
+	const int consumers = 1000;
+	ThreadPoolExecutor executor(2);
+	BlockingDequeue<int> queue;
+	atomic<int> sum(0), done(0);
+	for (int i = 0; i < consumers; ++i) consume(queue, executor, sum, done);
+
+	for (int i = 1; i <= 100; ++i) queue.put(i);
+	for (int i = 0; i < consumers; ++i) queue.put(-1);
+	while (done.load() != consumers) this_thread::yield();
+	ASSERT_EQ(sum.load(), 5050);
+	ASSERT_EQ(queue.size(), 0u);
+}
+
+static DetachedTask produce(BlockingDequeue<int>& queue, ThreadPoolExecutor& executor, int count, atomic<int>& done) {
+	for (int i = 0; i < count; ++i) co_await queue.asyncPut(executor, i);
+	done.fetch_add(1);
+}
+
+TEST(CoroutineUnitTest, asyncPut_is_wait_for_space) {
+	ThreadPoolExecutor executor(1);
+	BlockingDequeue<int> queue(2);
+	atomic<int> done(0);
+	produce(queue, executor, 10, done);
+	ASSERT_EQ(queue.size(), 2u);
+	ASSERT_EQ(done.load(), 0);
+
+	vector<int> values;
+	for (int i = 0; i < 10; ++i) values.push_back(queue.take());
+	while (done.load() != 1) this_thread::yield();
+	for (int i = 0; i < 10; ++i) ASSERT_EQ(values[static_cast<size_t>(i)], i);
+}
+
+static DetachedTask takeUntilClosed(BlockingDequeue<int>& queue, ThreadPoolExecutor& executor, promise<bool>& result) {
+	try {
+		co_await queue.asyncTake(executor);
+		result.set_value(false);
+	} catch (const DequeueClosedException&) {
+		result.set_value(true);
+	}
+}
+
+TEST(CoroutineUnitTest, asyncTake_is_resume_on_close) {
+	ThreadPoolExecutor executor(1);
+	BlockingDequeue<int> queue;
+	promise<bool> result;
+	takeUntilClosed(queue, executor, result);
+	queue.close();
+	ASSERT_TRUE(result.get_future().get());
+}
+
+static DetachedTask takeOne(BlockingDequeue<int>& queue, ThreadPoolExecutor& executor, promise<int>& result) {
+	try {
+		result.set_value(co_await queue.asyncTake(executor));
+	} catch (const DequeueClosedException&) {
+		result.set_value(-1);
+	}
+}
+
+TEST(CoroutineUnitTest, asyncTake_is_resume_in_producer_after_shutdown) {
+	ThreadPoolExecutor executor(1);
+	BlockingDequeue<int> queue;
+	promise<int> result;
+	takeOne(queue, executor, result);
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+
+	queue.put(42);
+	future<int> value = result.get_future();
+	ASSERT_EQ(value.wait_for(chrono::seconds(0)), future_status::ready);
+	ASSERT_EQ(value.get(), 42);
+}
+
+TEST(CoroutineUnitTest, asyncTake_is_resume_in_producer_when_executor_aborts) {
+	ThreadPoolExecutor executor(1, 1, RejectionPolicy::abort);
+	promise<void> started, release;
+	shared_future<void> released = release.get_future().share();
+	executor.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executor.execute([]() { });
+
+	BlockingDequeue<int> queue;
+	promise<int> first, second, third;
+	takeOne(queue, executor, first);
+	takeOne(queue, executor, second);
+	takeOne(queue, executor, third);
+	ASSERT_NO_THROW(queue.put(7));
+	ASSERT_EQ(first.get_future().get(), 7);
+	ASSERT_NO_THROW(queue.close());
+	ASSERT_EQ(second.get_future().get(), -1);
+	ASSERT_EQ(third.get_future().get(), -1);
+	release.set_value();
+}
+
+#endif // CONCURRENT_COROUTINES
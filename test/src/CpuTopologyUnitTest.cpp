@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "numaexecutor.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+
+using namespace std;
+
+/**
+ * Two nodes with two cores of two hardware threads each: node 0 - CPUs 0,1,4,5; node 1 - CPUs 2,3,6,7. CPUs n and
+ * n + 4 are siblings.
+ */
+static CpuTopology makeTwoNodeTopology() {
+	std::vector<CpuInfo> cpus;
+	for (int cpu = 0; cpu < 8; ++cpu) {
+		int node = (cpu % 4) / 2;
+		cpus.push_back(CpuInfo{cpu, cpu % 4, node, node});
+	}
+	return CpuTopology(cpus);
+}
+
+static void writeFile(const std::string& path, const std::string& content) {
+	std::ofstream file(path);
+	file << content << std::endl;
+}
+
+TEST(CpuTopologyUnitTest, parseCpuList_is_expand_ranges) {
+	ASSERT_EQ(CpuTopology::parseCpuList("0-3,8,10-11\n"), std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+	ASSERT_TRUE(CpuTopology::parseCpuList("").empty());
+}
+
+TEST(CpuTopologyUnitTest, parse_is_read_sysfs) {
+	char root[] = "/tmp/cputopologyXXXXXX";
+	ASSERT_NE(mkdtemp(root), nullptr);
+	std::string base(root);
+	for (const char* dir : {"/cpu", "/cpu/cpu0", "/cpu/cpu0/topology", "/cpu/cpu1", "/cpu/cpu1/topology", "/node",
+	                        "/node/node0", "/node/node1"}) {
+		ASSERT_EQ(mkdir((base + dir).c_str(), 0700), 0);
+	}
+	writeFile(base + "/cpu/online", "0-1");
+	writeFile(base + "/cpu/cpu0/topology/core_id", "0");
+	writeFile(base + "/cpu/cpu0/topology/physical_package_id", "0");
+	writeFile(base + "/cpu/cpu1/topology/core_id", "0");
+	writeFile(base + "/cpu/cpu1/topology/physical_package_id", "1");
+	writeFile(base + "/node/online", "0-1");
+	writeFile(base + "/node/node0/cpulist", "0");
+	writeFile(base + "/node/node1/cpulist", "1");
+
+	CpuTopology topology = CpuTopology::parse(base);
+	ASSERT_EQ(system(("rm -rf " + base).c_str()), 0);
+
+	ASSERT_EQ(topology.nodes(), std::vector<int>({0, 1}));
+	ASSERT_EQ(topology.cpusOfNode(1), std::vector<int>({1}));
+	ASSERT_EQ(topology.cpus()[1].package, 1);
+	ASSERT_EQ(topology.nodeOf(0), 0);
+	ASSERT_EQ(topology.nodeOf(5), -1);
+}
+
+TEST(CpuTopologyUnitTest, compact_is_fill_core_then_node) {
+	ASSERT_EQ(CpuPlacement(CpuPlacement::compact).cpus(makeTwoNodeTopology()), std::vector<int>({0, 4, 1, 5, 2, 6, 3, 7}));
+}
+
+TEST(CpuTopologyUnitTest, scatter_is_spread_over_nodes_and_cores) {
+	ASSERT_EQ(CpuPlacement(CpuPlacement::scatter).cpus(makeTwoNodeTopology()), std::vector<int>({0, 2, 1, 3, 4, 6, 5, 7}));
+}
+
+TEST(CpuTopologyUnitTest, detect_is_return_allowed_cpus) {
+	CpuTopology topology = CpuTopology::detect();
+	ASSERT_FALSE(topology.cpus().empty());
+	ASSERT_FALSE(topology.nodes().empty());
+	int cpu = currentCpu();
+	if (cpu >= 0) {
+		ASSERT_GE(topology.nodeOf(cpu), 0);
+	}
+}
+
+TEST(CpuTopologyUnitTest, affinityExecutor_is_pin_workers) {
+	int cpu = CpuTopology::detect().cpus().front().cpu;
+	AffinityThreadPoolExecutor executor(1, CpuPlacement(std::vector<int>(1, cpu)));
+	ASSERT_EQ(executor.submit([]() { return currentCpu(); }).get(), cpu);
+}
+
+TEST(CpuTopologyUnitTest, numaExecutor_is_run_on_node_cpus) {
+	CpuTopology topology = CpuTopology::detect();
+	NumaThreadPoolExecutor executor(1, topology);
+	ASSERT_EQ(executor.getPoolSize(), topology.nodes().size());
+	for (int node : executor.getNodes()) {
+		int cpu = executor.submit(NumaNode(node), []() { return currentCpu(); }).get();
+		ASSERT_EQ(topology.nodeOf(cpu), node);
+	}
+	ASSERT_THROW(executor.execute(NumaNode(-1), []() { }), std::out_of_range);
+	ASSERT_EQ(executor.submit([]() { return 1; }).get(), 1);
+}
+
+TEST(CpuTopologyUnitTest, numaExecutor_is_use_one_pool_without_nodes) {
+	NumaThreadPoolExecutor executor(2, CpuTopology(std::vector<CpuInfo>()));
+	ASSERT_TRUE(executor.getNodes().empty());
+	ASSERT_EQ(executor.getPoolSize(), 2);
+	ASSERT_EQ(executor.submit([]() { return 1; }).get(), 1);
+	ASSERT_THROW(executor.execute(NumaNode(0), []() { }), std::out_of_range);
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+}
@@ -2,6 +2,10 @@
 #include "testutil.h"
 #include "executor.h"
 
+#include <ctime>
+#include <functional>
+#include <stdexcept>
+
 using namespace std;
 using namespace chrono;
 
@@ -43,8 +47,7 @@ TEST(ExcutorIntegrationTest, execute_is_execute_before_shutdown) {
     ASSERT_TRUE(isRunnableInvoke);
 }
 
-// FIXME
-TEST(DISABLED_ExcutorIntegrationTest, execute_is_awaitTermination_wait) {
+TEST(ExcutorIntegrationTest, execute_is_awaitTermination_wait) {
     ThreadPoolExecutor executorService(1);
     executorService.execute([&]() {
 		this_thread::sleep_for(milliseconds(2 * WAIT_THREAD_TIME_MS));
@@ -56,3 +59,305 @@ TEST(DISABLED_ExcutorIntegrationTest, execute_is_awaitTermination_wait) {
     ASSERT_GE(wait_time, WAIT_THREAD_TIME_MS);
     ASSERT_LE(wait_time, 4 * WAIT_THREAD_TIME_MS);
 }
+
+TEST(ExcutorIntegrationTest, shutdown_is_wake_idle_workers) {
+	ThreadPoolExecutor executorService(THREAD_COUNT);
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	auto start_time = high_resolution_clock::now();
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS));
+	ASSERT_LE(duration_cast<milliseconds>(high_resolution_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS);
+}
+
+TEST(ExcutorIntegrationTest, shutdown_is_not_spin_finished_workers) {
+	ThreadPoolExecutor executorService(THREAD_COUNT * 2);
+	executorService.execute([]() { this_thread::sleep_for(milliseconds(10)); });
+	for (int i = 1; i < THREAD_COUNT * 2; ++i) {
+		executorService.execute([]() { this_thread::sleep_for(milliseconds(300)); });
+	}
+	executorService.shutdown();
+	clock_t cpuStart = clock();
+	ASSERT_TRUE(executorService.awaitTermination(1000));
+	double cpuMs = static_cast<double>(clock() - cpuStart) * 1000. / CLOCKS_PER_SEC;
+	ASSERT_LT(cpuMs, 100.);
+}
+
+TEST(ExcutorIntegrationTest, awaitTermination_is_false_when_timeout) {
+	ThreadPoolExecutor executorService(1);
+	executorService.execute([&]() {
+		this_thread::sleep_for(milliseconds(3 * WAIT_THREAD_TIME_MS));
+	});
+	executorService.shutdown();
+	auto start_time = high_resolution_clock::now();
+	ASSERT_FALSE(executorService.awaitTermination(WAIT_THREAD_TIME_MS));
+	ASSERT_LE(duration_cast<milliseconds>(high_resolution_clock::now() - start_time).count(), 2 * WAIT_THREAD_TIME_MS);
+	ASSERT_TRUE(executorService.awaitTermination(10 * WAIT_THREAD_TIME_MS));
+}
+
+class StartCountingExecutor : public ThreadPoolExecutor {
+public:
+	StartCountingExecutor(size_t corePoolSize, size_t maximumPoolSize, int keepAliveMs, std::atomic_int& started)
+			: ThreadPoolExecutor(corePoolSize, maximumPoolSize, keepAliveMs, [&started](std::thread*) { ++started; }) { }
+};
+
+TEST(ExcutorIntegrationTest, execute_is_grow_pool_when_queue_backs_up) {
+	const int keepAliveMs = WAIT_THREAD_TIME_MS;
+	std::atomic_int started(0);
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	StartCountingExecutor executorService(1, 3, keepAliveMs, started);
+	ASSERT_EQ(executorService.getPoolSize(), 1);
+
+	for (int i = 0; i < 10; ++i) {
+		executorService.execute([&]() {
+			released.wait();
+			++executed;
+		});
+	}
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	ASSERT_EQ(executorService.getPoolSize(), 3);
+	ASSERT_EQ(started.load(), 3);
+
+	release.set_value();
+	this_thread::sleep_for(milliseconds(keepAliveMs * 4));
+	ASSERT_EQ(executed.load(), 10);
+	ASSERT_EQ(executorService.getPoolSize(), 1);
+}
+
+TEST(ExcutorIntegrationTest, awaitTermination_is_wait_extra_workers) {
+	std::atomic_int executed(0);
+	ThreadPoolExecutor executorService(1, 4, WAIT_THREAD_TIME_MS * 100);
+	for (int i = 0; i < 20; ++i) {
+		executorService.execute([&]() {
+			this_thread::sleep_for(milliseconds(1));
+			++executed;
+		});
+	}
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+	ASSERT_EQ(executed.load(), 20);
+}
+
+TEST(ExcutorIntegrationTest, extra_workers_is_retire_with_zero_keepAlive) {
+	ASSERT_THROW(ThreadPoolExecutor(1, 2, -1), std::invalid_argument);
+
+	std::atomic_int executed(0);
+	ThreadPoolExecutor executorService(1, 4, 0);
+	for (int round = 0; round < 20; ++round) {
+		for (int i = 0; i < 8; ++i) executorService.execute([&executed]() { ++executed; });
+		this_thread::sleep_for(milliseconds(1));
+	}
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+	ASSERT_EQ(executed.load(), 160);
+}
+
+/**
+ * Occupies the only worker of the executor until release is set, then fills the queue of capacity 1.
+ */
+static void fillExecutor(ThreadPoolExecutor& executorService, std::shared_future<void> released, std::atomic_int& executed) {
+	std::promise<void> started;
+	executorService.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executorService.execute([&executed]() { ++executed; });
+}
+
+TEST(ExcutorIntegrationTest, discard_is_break_future_when_queue_full) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::discard);
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	auto future = executorService.submit([]() { return 1; });
+	release.set_value();
+	ASSERT_THROW(future.get(), std::future_error);
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS));
+	ASSERT_EQ(executed.load(), 1);
+}
+
+TEST(ExcutorIntegrationTest, callerRuns_is_run_in_caller_thread_when_queue_full) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::caller_runs);
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	auto future = executorService.submit([]() { return this_thread::get_id(); });
+	ASSERT_EQ(future.get(), this_thread::get_id());
+	release.set_value();
+}
+
+TEST(ExcutorIntegrationTest, discardOldest_is_replace_oldest_task_when_queue_full) {
+	std::atomic_int executed(0);
+	std::atomic_int executedNewest(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::discard_oldest);
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	executorService.execute([&]() { ++executedNewest; });
+	release.set_value();
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS));
+	ASSERT_EQ(executed.load(), 0);
+	ASSERT_EQ(executedNewest.load(), 1);
+}
+
+TEST(ExcutorIntegrationTest, abort_is_throw_when_queue_full) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::abort);
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	ASSERT_THROW(executorService.execute([]() { }), RejectedExecutionException);
+	release.set_value();
+}
+
+TEST(ExcutorIntegrationTest, block_is_wait_for_space_when_queue_full) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::block);
+	fillExecutor(executorService, released, executed);
+
+	std::thread releaser([&]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		release.set_value();
+	});
+	auto start_time = steady_clock::now();
+	auto future = executorService.submit([]() { return 1; });
+	ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS - 1);
+	ASSERT_EQ(future.get(), 1);
+	releaser.join();
+}
+
+TEST(ExcutorIntegrationTest, block_is_reject_when_shutdown_closes_queue) {
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper>, ExecutorStats> executorService(
+			1, 1, RejectionPolicy::block);
+	executorService.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executorService.execute([]() { });
+
+	std::future<int> single;
+	Future<std::vector<int>> batch;
+	std::thread submitter([&]() { single = executorService.submit([]() { return 1; }); });
+	std::thread batchSubmitter([&]() {
+		batch = executorService.submitAll(std::vector<std::function<int()>>(3, []() { return 2; }));
+	});
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	executorService.shutdown();
+	submitter.join();
+	batchSubmitter.join();
+	release.set_value();
+	ASSERT_TRUE(executorService.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+
+	ASSERT_THROW(single.get(), std::future_error);
+	ASSERT_ANY_THROW(batch.get());
+	ExecutorStatsSnapshot snapshot = executorService.snapshot();
+	ASSERT_EQ(snapshot.completed, 2);
+	ASSERT_EQ(snapshot.queueDepth, 0);
+	ASSERT_EQ(snapshot.submitted, 2 + snapshot.rejected);
+}
+
+TEST(ExcutorIntegrationTest, shutdown_is_not_block_on_full_queue) {
+	std::atomic_int executed(0);
+	std::promise<void> started, filled;
+	std::shared_future<void> isFilled = filled.get_future().share();
+	ThreadPoolExecutor executorService(1, 2, RejectionPolicy::discard);
+	executorService.execute([&executorService, &started, isFilled]() {
+		started.set_value();
+		isFilled.wait();
+		executorService.shutdown();
+	});
+	started.get_future().wait();
+	for (int i = 0; i < 2; ++i) executorService.execute([&executed]() { ++executed; });
+	filled.set_value();
+	ASSERT_TRUE(executorService.awaitTermination(2000));
+	ASSERT_EQ(executed.load(), 2);
+
+	ThreadPoolExecutor shutdownNowService(1, 1, RejectionPolicy::discard);
+	std::promise<void> nowStarted;
+	shutdownNowService.execute([&shutdownNowService, &nowStarted]() {
+		nowStarted.set_value();
+		shutdownNowService.shutdownNow();
+	});
+	nowStarted.get_future().wait();
+	shutdownNowService.execute([&executed]() { ++executed; });
+	ASSERT_TRUE(shutdownNowService.awaitTermination(2000));
+}
+
+TEST(ExcutorIntegrationTest, rejectionHandler_is_get_rejected_task) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::abort);
+	std::vector<FunctionWrapper> rejected;
+	executorService.setRejectionHandler([&](FunctionWrapper&& task) { rejected.push_back(std::move(task)); });
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	executorService.execute([&]() { ++executed; });
+	ASSERT_EQ(rejected.size(), 1);
+	rejected.front()();
+	ASSERT_EQ(executed.load(), 1);
+	release.set_value();
+}
+
+TEST(ExcutorIntegrationTest, executeAll_is_run_all_tasks) {
+	std::atomic_int executed(0);
+	std::vector<std::function<void()>> tasks(1000, [&]() { ++executed; });
+	ThreadPoolExecutor executorService(4);
+	executorService.executeAll(tasks.begin(), tasks.end());
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(1000));
+	ASSERT_EQ(executed.load(), 1000);
+}
+
+TEST(ExcutorIntegrationTest, submitAll_is_collect_results_in_order) {
+	auto square = [](int i) { return [i]() { return i * i; }; };
+	std::vector<decltype(square(0))> tasks;
+	for (int i = 0; i < 1000; ++i) tasks.push_back(square(i));
+	ThreadPoolExecutor executorService(4);
+
+	std::vector<int> results = executorService.submitAll(tasks).get();
+	ASSERT_EQ(results.size(), 1000);
+	for (int i = 0; i < 1000; ++i) ASSERT_EQ(results[i], i * i);
+
+	std::atomic_int executed(0);
+	std::vector<std::function<void()>> voids(100, [&]() { ++executed; });
+	executorService.submitAll(voids).get();
+	ASSERT_EQ(executed.load(), 100);
+
+	std::vector<std::function<void()>> none;
+	ASSERT_TRUE(executorService.submitAll(none).isReady());
+}
+
+TEST(ExcutorIntegrationTest, submitAll_is_pass_first_exception_after_all_tasks) {
+	std::atomic_int executed(0);
+	std::vector<std::function<int()>> tasks(10, [&]() { return ++executed; });
+	tasks[3] = []() -> int { throw std::runtime_error("fail"); };
+	ThreadPoolExecutor executorService(2);
+	ASSERT_THROW(executorService.submitAll(tasks).get(), std::runtime_error);
+	ASSERT_EQ(executed.load(), 9);
+}
+
+TEST(ExcutorIntegrationTest, submitAll_is_break_future_when_tasks_dropped) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	ThreadPoolExecutor executorService(1, 1, RejectionPolicy::discard);
+	fillExecutor(executorService, release.get_future().share(), executed);
+
+	std::vector<std::function<void()>> tasks(3, [&]() { ++executed; });
+	auto future = executorService.submitAll(tasks);
+	release.set_value();
+	ASSERT_THROW(future.get(), std::future_error);
+
+	executorService.shutdown();
+	ASSERT_THROW(executorService.submitAll(tasks).get(), std::future_error);
+}
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "executor.h"
+
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+TEST(ExecutorStatsUnitTest, logHistogram_is_bucket_contain_value) {
+	for (uint64_t v : {uint64_t(0), uint64_t(3), uint64_t(4), uint64_t(7), uint64_t(8), uint64_t(1000), uint64_t(123456789),
+	                   UINT64_MAX}) {
+		size_t bucket = LogHistogram::bucketOf(v);
+		ASSERT_LT(bucket, size_t(LogHistogram::BUCKETS));
+		ASSERT_LE(LogHistogramSnapshot::bucketLowerBound(bucket), v);
+		ASSERT_GE(LogHistogramSnapshot::bucketUpperBound(bucket), v);
+	}
+}
+
+TEST(ExecutorStatsUnitTest, logHistogram_is_return_percentiles) {
+	LogHistogram histogram;
+	for (uint64_t v = 1; v <= 1000; ++v) histogram.record(v);
+	LogHistogramSnapshot snapshot;
+	histogram.addTo(snapshot);
+	ASSERT_EQ(snapshot.count, 1000);
+	uint64_t median = snapshot.percentile(0.5);
+	ASSERT_GE(median, 500);
+	ASSERT_LE(median, 500 * 5 / 4);
+	ASSERT_GE(snapshot.percentile(1.0), 1000);
+}
+
+TEST(ExecutorStatsUnitTest, stripedCounter_is_sum_threads) {
+	StripedCounter<> counter;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&counter]() {
+			for (int i = 0; i < 1000; ++i) counter.increment();
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	ASSERT_EQ(counter.load(), 4000);
+}
+
+TEST(ExecutorStatsUnitTest, snapshot_is_count_tasks) {
+	const int count = 100;
+	InstrumentedThreadPoolExecutor executor(2);
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < count; ++i) {
+		futures.push_back(executor.submit([]() { this_thread::sleep_for(microseconds(100)); }));
+	}
+	for (auto& future : futures) future.get();
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+
+	ExecutorStatsSnapshot snapshot = executor.snapshot();
+	ASSERT_EQ(snapshot.submitted, count);
+	ASSERT_EQ(snapshot.completed, count);
+	ASSERT_EQ(snapshot.rejected, 0);
+	ASSERT_EQ(snapshot.queueDepth, 0);
+	ASSERT_GE(snapshot.queueHighWater, 1);
+	ASSERT_EQ(snapshot.workers.size(), 2);
+	uint64_t busyNs = 0, tasks = 0;
+	for (auto& worker : snapshot.workers) {
+		busyNs += worker.busyNs;
+		tasks += worker.tasks;
+	}
+	ASSERT_EQ(tasks, count);
+	ASSERT_GE(busyNs, count * 100000);
+	ASSERT_EQ(snapshot.runTimeNs.count, count);
+	ASSERT_EQ(snapshot.queueWaitNs.count, count);
+	ASSERT_GE(snapshot.runTimeNs.percentile(0.5), 100000);
+}
+
+TEST(ExecutorStatsUnitTest, snapshot_is_count_rejected) {
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper>, ExecutorStats> executor(1, 1, RejectionPolicy::discard);
+	executor.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executor.execute([]() { });
+	executor.execute([]() { });
+
+	ExecutorStatsSnapshot snapshot = executor.snapshot();
+	ASSERT_EQ(snapshot.submitted, 3);
+	ASSERT_EQ(snapshot.rejected, 1);
+	ASSERT_EQ(snapshot.queueDepth, 1);
+	release.set_value();
+}
+
+TEST(ExecutorStatsUnitTest, snapshot_is_derive_queue_depth_and_high_water) {
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	InstrumentedThreadPoolExecutor executor(1);
+	executor.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	for (int i = 0; i < 10; ++i) executor.execute([]() { });
+
+	ExecutorStatsSnapshot snapshot = executor.snapshot();
+	ASSERT_EQ(snapshot.queueDepth, 10);
+	ASSERT_EQ(snapshot.queueHighWater, 10);
+	release.set_value();
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+
+	snapshot = executor.snapshot();
+	ASSERT_EQ(snapshot.queueDepth, 0);
+	ASSERT_EQ(snapshot.queueHighWater, 10);
+}
+
+TEST(ExecutorStatsUnitTest, snapshot_is_zero_without_stats) {
+	ThreadPoolExecutor executor(1);
+	executor.submit([]() { }).get();
+	ASSERT_EQ(executor.snapshot().submitted, 0);
+}
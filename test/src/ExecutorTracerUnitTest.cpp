@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "executor.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+TEST(ExecutorTracerUnitTest, events_is_ordered_timestamps_per_worker) {
+	TracedThreadPoolExecutor executor(2);
+	const int count = 20;
+	for (int i = 0; i < count; ++i) executor.execute([]() { this_thread::sleep_for(microseconds(100)); });
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+
+	vector<TraceEvent> events = executor.traceEvents();
+	ASSERT_EQ(events.size(), count);
+	for (const TraceEvent& e : events) {
+		ASSERT_GE(e.worker, 0);
+		ASSERT_LT(e.worker, 2);
+		ASSERT_LE(e.enqueueNs, e.dequeueNs);
+		ASSERT_LE(e.dequeueNs, e.startNs);
+		ASSERT_GE(e.finishNs - e.startNs, 100000);
+	}
+}
+
+TEST(ExecutorTracerUnitTest, ring_is_keep_last_events) {
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper>, NoExecutorStats, ExecutorTracer<8>> executor(1);
+	for (int i = 0; i < 20; ++i) executor.execute([]() { });
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+
+	vector<TraceEvent> events = executor.traceEvents();
+	ASSERT_EQ(events.size(), 8);
+	for (size_t i = 1; i < events.size(); ++i) ASSERT_LE(events[i - 1].finishNs, events[i].startNs);
+}
+
+TEST(ExecutorTracerUnitTest, events_is_not_torn_when_read_concurrently) {
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper>, NoExecutorStats, ExecutorTracer<8>> executor(1);
+	std::atomic_bool isDone(false);
+	std::thread producer([&]() {
+		for (int i = 0; i < 20000; ++i) executor.execute([]() { });
+		executor.shutdown();
+		isDone = true;
+	});
+	while (!isDone) {
+		vector<TraceEvent> events = executor.traceEvents();
+		ASSERT_LE(events.size(), 8);
+		for (size_t i = 0; i < events.size(); ++i) {
+			ASSERT_LE(events[i].enqueueNs, events[i].dequeueNs);
+			ASSERT_LE(events[i].dequeueNs, events[i].startNs);
+			ASSERT_LE(events[i].startNs, events[i].finishNs);
+		}
+		for (size_t i = 1; i < events.size(); ++i) ASSERT_LE(events[i - 1].finishNs, events[i].startNs);
+	}
+	producer.join();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+}
+
+TEST(ExecutorTracerUnitTest, caller_runs_is_traced_as_external) {
+	std::promise<void> started, release;
+	std::shared_future<void> released = release.get_future().share();
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper>, NoExecutorStats, ExecutorTracer<>> executor(
+			1, 1, RejectionPolicy::caller_runs);
+	executor.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executor.execute([]() { });
+	executor.execute([]() { });
+
+	vector<TraceEvent> events = executor.traceEvents();
+	ASSERT_EQ(events.size(), 1);
+	ASSERT_EQ(events[0].worker, -1);
+	release.set_value();
+}
+
+TEST(ExecutorTracerUnitTest, writeTrace_is_write_chrome_json) {
+	TracedThreadPoolExecutor executor(1);
+	executor.execute([]() { });
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+	ostringstream out;
+	executor.writeTrace(out);
+	string json = out.str();
+	ASSERT_EQ(json.find("{\"traceEvents\":["), 0);
+	ASSERT_NE(json.find("\"name\":\"worker 0\""), string::npos);
+	ASSERT_NE(json.find("\"ph\":\"X\""), string::npos);
+	ASSERT_NE(json.find("\"ph\":\"b\""), string::npos);
+	ASSERT_EQ(json.substr(json.size() - 2), "]}");
+
+	ThreadPoolExecutor untraced(1);
+	untraced.submit([]() { }).get();
+	ASSERT_TRUE(untraced.traceEvents().empty());
+}
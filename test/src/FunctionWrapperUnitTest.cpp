@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+#include "executor.h"
+
+#include <array>
+#include <memory>
+
+struct CallCounter {
+	int* calls;
+	std::shared_ptr<int> alive;
+
+	void operator()() { ++*calls; }
+};
+
+struct LargeCallCounter {
+	int* calls;
+	std::array<char, 256> payload;
+
+	void operator()() { ++*calls; }
+};
+
+TEST(FunctionWrapperUnitTest, is_one_cache_line) {
+	ASSERT_EQ(sizeof(FunctionWrapper), 64);
+}
+
+TEST(FunctionWrapperUnitTest, is_small_callable_inline) {
+	ASSERT_TRUE(FunctionWrapper::isInline<CallCounter>());
+	ASSERT_TRUE(FunctionWrapper::isInline<std::packaged_task<int()>>());
+	ASSERT_FALSE(FunctionWrapper::isInline<LargeCallCounter>());
+}
+
+TEST(FunctionWrapperUnitTest, call_is_invoke_inline_callable) {
+	int calls = 0;
+	FunctionWrapper wrapper(CallCounter{&calls, nullptr});
+	wrapper();
+	ASSERT_EQ(calls, 1);
+}
+
+TEST(FunctionWrapperUnitTest, call_is_invoke_heap_callable) {
+	int calls = 0;
+	FunctionWrapper wrapper(LargeCallCounter{&calls, {}});
+	FunctionWrapper moved(std::move(wrapper));
+	moved();
+	ASSERT_EQ(calls, 1);
+	ASSERT_FALSE(wrapper);
+}
+
+TEST(FunctionWrapperUnitTest, construct_is_copy_lvalue_callable) {
+	int calls = 0;
+	std::unique_ptr<FunctionWrapper> wrapper;
+	{
+		CallCounter counter{&calls, nullptr};
+		wrapper.reset(new FunctionWrapper(counter));
+	}
+	(*wrapper)();
+	ASSERT_EQ(calls, 1);
+}
+
+TEST(FunctionWrapperUnitTest, move_is_callable_destroyed_once) {
+	int calls = 0;
+	std::shared_ptr<int> alive = std::make_shared<int>(0);
+	{
+		FunctionWrapper wrapper(CallCounter{&calls, alive});
+		FunctionWrapper other;
+		other = std::move(wrapper);
+		EXPECT_FALSE(wrapper);
+		EXPECT_TRUE(other);
+		EXPECT_EQ(alive.use_count(), 2);
+	}
+	ASSERT_EQ(alive.use_count(), 1);
+}
+
+TEST(FunctionWrapperUnitTest, is_empty_by_default) {
+	FunctionWrapper wrapper;
+	ASSERT_FALSE(wrapper);
+}
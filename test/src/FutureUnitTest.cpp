@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+#include "executor.h"
+#include "future.h"
+
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(FutureUnitTest, promise_is_pass_value_to_future) {
+	Promise<int> promise;
+	Future<int> future = promise.getFuture();
+	ASSERT_FALSE(future.isReady());
+	ASSERT_FALSE(future.waitFor(1));
+
+	promise.setValue(42);
+	ASSERT_TRUE(future.isReady());
+	ASSERT_EQ(future.get(), 42);
+	ASSERT_FALSE(future.valid());
+}
+
+TEST(FutureUnitTest, promise_is_pass_exception_and_break) {
+	Promise<int> promise;
+	Future<int> future = promise.getFuture();
+	promise.setException(make_exception_ptr(runtime_error("fail")));
+	ASSERT_THROW(future.get(), runtime_error);
+	ASSERT_THROW(promise.setValue(1), future_error);
+
+	Future<void> broken;
+	{
+		Promise<void> dropped;
+		broken = dropped.getFuture();
+	}
+	try {
+		broken.get();
+		FAIL();
+	} catch (const future_error& e) {
+		ASSERT_EQ(e.code(), make_error_code(future_errc::broken_promise));
+	}
+}
+
+TEST(FutureUnitTest, state_is_one_cache_line_with_control_block) {
+	ASSERT_LE(sizeof(FutureState<int>) + 2 * sizeof(void*), CACHE_LINE_SIZE);
+	ASSERT_LE(sizeof(FutureState<void>) + 2 * sizeof(void*), CACHE_LINE_SIZE);
+}
+
+TEST(FutureUnitTest, wait_is_woken_by_other_thread) {
+	for (int i = 0; i < 100; ++i) {
+		Promise<int> promise;
+		Future<int> future = promise.getFuture();
+		thread setter([&promise, i]() {
+			this_thread::sleep_for(chrono::microseconds(100));
+			promise.setValue(i);
+		});
+		ASSERT_EQ(future.get(), i);
+		setter.join();
+	}
+}
+
+TEST(FutureUnitTest, submit_use_future_is_move_result_out) {
+	ThreadPoolExecutor executor(1);
+	Promise<void> gate;
+	Future<void> opened = gate.getFuture();
+	Future<unique_ptr<int>> future = executor.submit(use_future, [&opened]() {
+		opened.wait();
+		return unique_ptr<int>(new int(42));
+	});
+	ASSERT_FALSE(future.ready());
+	ASSERT_EQ(future.wait_for(chrono::milliseconds(1)), future_status::timeout);
+
+	gate.setValue();
+	ASSERT_EQ(future.wait_for(chrono::seconds(10)), future_status::ready);
+	ASSERT_TRUE(future.ready());
+	ASSERT_EQ(*future.get(), 42);
+
+	std::future<int> compatible = executor.submit([]() { return 1; });
+	ASSERT_EQ(compatible.get(), 1);
+}
+
+TEST(FutureUnitTest, then_is_chain_inline_continuations) {
+	Promise<int> promise;
+	Future<string> future = promise.getFuture()
+			.then([](int value) { return value * 2; })
+			.then([](int value) { return to_string(value); });
+	ASSERT_FALSE(future.isReady());
+
+	promise.setValue(21);
+	ASSERT_EQ(future.get(), "42");
+}
+
+TEST(FutureUnitTest, then_is_skip_continuation_on_exception) {
+	Promise<int> promise;
+	bool isCalled = false;
+	Future<void> future = promise.getFuture().then([&](int) { isCalled = true; });
+	promise.setException(make_exception_ptr(runtime_error("fail")));
+
+	ASSERT_THROW(future.get(), runtime_error);
+	ASSERT_FALSE(isCalled);
+}
+
+TEST(FutureUnitTest, then_is_run_continuation_on_executor) {
+	ThreadPoolExecutor executor(2);
+	Future<int> future = executor.async([]() { return 20; })
+			.then(executor, [](int value) { return value + 1; })
+			.then(executor, [](int value) { return value * 2; });
+	ASSERT_EQ(future.get(), 42);
+}
+
+TEST(FutureUnitTest, then_is_fail_continuation_when_executor_rejects) {
+	promise<void> started, release;
+	shared_future<void> released = release.get_future().share();
+	ThreadPoolExecutor executor(1, 1, RejectionPolicy::abort);
+	executor.execute([&started, released]() {
+		started.set_value();
+		released.wait();
+	});
+	started.get_future().wait();
+	executor.execute([]() { });
+
+	Promise<int> input;
+	Future<int> future = input.getFuture().then(executor, [](int value) { return value + 1; });
+	input.setValue(1);
+	ASSERT_THROW(future.get(), RejectedExecutionException);
+	release.set_value();
+
+	Promise<int> dropped;
+	ThreadPoolExecutor discarding(1, 1, RejectionPolicy::discard);
+	discarding.shutdown();
+	Future<int> droppedFuture = dropped.getFuture().then(discarding, [](int value) { return value; });
+	dropped.setValue(1);
+	ASSERT_THROW(droppedFuture.get(), future_error);
+}
+
+TEST(FutureUnitTest, async_is_break_promise_after_shutdown) {
+	ThreadPoolExecutor executor(1);
+	executor.shutdown();
+	Future<int> future = executor.async([]() { return 1; });
+	ASSERT_THROW(future.get(), future_error);
+}
+
+TEST(FutureUnitTest, whenAll_is_collect_values_in_order) {
+	vector<Promise<int>> promises(3);
+	vector<Future<int>> futures;
+	for (auto& promise : promises) futures.push_back(promise.getFuture());
+	Future<vector<int>> all = whenAll(futures);
+
+	promises[2].setValue(3);
+	promises[0].setValue(1);
+	ASSERT_FALSE(all.isReady());
+	promises[1].setValue(2);
+	ASSERT_EQ(all.get(), vector<int>({1, 2, 3}));
+
+	vector<Future<void>> empty;
+	ASSERT_TRUE(whenAll(empty).isReady());
+}
+
+TEST(FutureUnitTest, whenAny_is_return_first_ready) {
+	vector<Promise<string>> promises(3);
+	vector<Future<string>> futures;
+	for (auto& promise : promises) futures.push_back(promise.getFuture());
+	Future<WhenAnyResult<string>> any = whenAny(futures);
+
+	promises[1].setValue("first");
+	promises[0].setValue("second");
+	WhenAnyResult<string> result = any.get();
+	ASSERT_EQ(result.index, 1u);
+	ASSERT_EQ(result.value, "first");
+}
+
+/**
+ * Diamond graph a -> (b, c) -> d on a single worker. No task blocks the worker, so the graph completes on any pool size.
+ */
+TEST(FutureUnitTest, whenAny_is_fail_at_once_when_empty) {
+	vector<Future<int>> futures;
+	Future<WhenAnyResult<int>> any = whenAny(futures);
+	ASSERT_TRUE(any.isReady());
+	ASSERT_THROW(any.get(), invalid_argument);
+}
+
+TEST(FutureUnitTest, task_graph_is_complete_on_single_worker) {
+	ThreadPoolExecutor executor(1);
+	for (int i = 0; i < 100; ++i) {
+		shared_ptr<Promise<int>> b = make_shared<Promise<int>>();
+		shared_ptr<Promise<int>> c = make_shared<Promise<int>>();
+		vector<Future<int>> branches;
+		branches.push_back(b->getFuture().then(executor, [](int value) { return value + 1; }));
+		branches.push_back(c->getFuture().then(executor, [](int value) { return value * 2; }));
+		Future<int> d = whenAll(branches).then(executor, [](vector<int> values) { return values[0] + values[1]; });
+
+		Future<void> a = executor.async([i]() { return i; }).then([b, c](int value) {
+			b->setValue(value);
+			c->setValue(value);
+		});
+
+		ASSERT_EQ(d.get(), i + 1 + i * 2);
+	}
+}
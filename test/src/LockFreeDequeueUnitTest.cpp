@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "lockfreedequeue.h"
+#include "executor.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+TEST(LockFreeDequeueUnitTest, construct_is_capacity_rounded_to_power_of_2) {
+	LockFreeDequeue<int> dequeue(5);
+	ASSERT_EQ(dequeue.capacity(), 8);
+}
+
+TEST(LockFreeDequeueUnitTest, offer_is_false_when_capacity_reach) {
+	LockFreeDequeue<int> dequeue(2);
+	EXPECT_TRUE(dequeue.offer(1));
+	EXPECT_TRUE(dequeue.offer(2));
+	ASSERT_FALSE(dequeue.offer(3));
+}
+
+TEST(LockFreeDequeueUnitTest, offer2_is_false_when_timeout) {
+	LockFreeDequeue<int> dequeue(2);
+	dequeue.put(1);
+	dequeue.put(2);
+	auto start_time = steady_clock::now();
+	ASSERT_FALSE(dequeue.offer(3, WAIT_THREAD_TIME_MS));
+	ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS);
+}
+
+TEST(LockFreeDequeueUnitTest, take_is_fifo) {
+	LockFreeDequeue<int> dequeue(4);
+	dequeue.put(111);
+	dequeue.put(222);
+	ASSERT_EQ(dequeue.take(), 111);
+	ASSERT_EQ(dequeue.take(), 222);
+}
+
+TEST(LockFreeDequeueUnitTest, poll_is_default_value_when_empty) {
+	LockFreeDequeue<std::string> dequeue(4);
+	bool isOk = true;
+	ASSERT_EQ(dequeue.poll(std::string("default"), &isOk), "default");
+	ASSERT_FALSE(isOk);
+}
+
+TEST(LockFreeDequeueUnitTest, poll_timeouted_is_default_value_when_empty) {
+	LockFreeDequeue<std::string> dequeue(4);
+	bool isOk = true;
+	ASSERT_EQ(dequeue.poll(10, std::string("default"), &isOk), "default");
+	ASSERT_FALSE(isOk);
+}
+
+TEST(LockFreeDequeueUnitTest, size_is_eq_to_num_of_elements) {
+	LockFreeDequeue<int> dequeue(4);
+	ASSERT_EQ(dequeue.size(), 0);
+	dequeue.offer(111);
+	ASSERT_EQ(dequeue.size(), 1);
+	ASSERT_EQ(dequeue.remainingCapacity(), 3);
+}
+
+TEST(LockFreeDequeueUnitTest, drainTo_is_elements_moved) {
+	LockFreeDequeue<int> dequeue(4);
+	dequeue.put(111);
+	dequeue.put(222);
+	dequeue.put(333);
+	std::deque<int> other;
+	ASSERT_EQ(dequeue.drainTo(other, 2), 2);
+	ASSERT_EQ(other, std::deque<int>({111, 222}));
+	ASSERT_EQ(dequeue.size(), 1);
+}
+
+TEST(LockFreeDequeueUnitTest, take_is_unblocked_by_put) {
+	LockFreeDequeue<int> dequeue(4);
+	TestUtil testUtil;
+	ASSERT_TRUE(testUtil.createThread([&dequeue]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		dequeue.put(111);
+	}));
+	ASSERT_EQ(dequeue.take(), 111);
+}
+
+TEST(LockFreeDequeueUnitTest, put_is_unblocked_by_take) {
+	LockFreeDequeue<int> dequeue(2);
+	dequeue.put(1);
+	dequeue.put(2);
+	std::atomic_bool isPut(false);
+	std::thread producer([&]() {
+		dequeue.put(3);
+		isPut = true;
+	});
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	EXPECT_FALSE(isPut);
+	EXPECT_EQ(dequeue.take(), 1);
+	producer.join();
+	ASSERT_TRUE(isPut);
+}
+
+TEST(LockFreeDequeueUnitTest, mpmc_is_every_element_taken_once) {
+	const int producerCount = 4, consumerCount = 4, perProducer = 20000;
+	LockFreeDequeue<int> dequeue(64);
+	std::atomic<long long> sum(0);
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producerCount; ++p) {
+		threads.emplace_back([&]() {
+			for (int i = 1; i <= perProducer; ++i) dequeue.put(i);
+		});
+	}
+	for (int c = 0; c < consumerCount; ++c) {
+		threads.emplace_back([&]() {
+			for (int i = 0; i < perProducer; ++i) sum += dequeue.take();
+		});
+	}
+	for (auto& thread : threads) thread.join();
+	ASSERT_EQ(sum.load(), static_cast<long long>(producerCount) * perProducer * (perProducer + 1) / 2);
+	ASSERT_EQ(dequeue.size(), 0);
+}
+
+TEST(LockFreeDequeueUnitTest, executor_is_runnable_invoke) {
+	std::atomic_int invokedRunnables(0);
+	{
+		ThreadPoolExecutorTemplate<std::thread, LockFreeDequeue<FunctionWrapper>> executorService(THREAD_COUNT);
+		for (int i = 0; i < 100; ++i) executorService.execute([&]() { invokedRunnables++; });
+		executorService.shutdown();
+	}
+	ASSERT_EQ(invokedRunnables, 100);
+}
+
+TEST(LockFreeDequeueUnitTest, close_is_drain_remaining_and_wake_takers) {
+	LockFreeDequeue<int> dequeue(4);
+	ASSERT_TRUE(dequeue.put(1));
+	dequeue.close();
+	ASSERT_FALSE(dequeue.offer(2));
+	int value = 0;
+	ASSERT_EQ(dequeue.takeStatus(value), DequeueStatus::ok);
+	ASSERT_EQ(value, 1);
+	ASSERT_EQ(dequeue.takeStatus(value), DequeueStatus::closed);
+	ASSERT_TRUE(dequeue.isDrained());
+
+	LockFreeDequeue<int> waited(4);
+	ASSERT_EQ(waited.pollStatus(value, 1), DequeueStatus::timeout);
+	std::thread closer([&waited]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_THREAD_TIME_MS));
+		waited.close();
+	});
+	ASSERT_EQ(waited.takeStatus(value), DequeueStatus::closed);
+	closer.join();
+}
+
+TEST(LockFreeDequeueUnitTest, take_is_throw_when_closed_and_drained) {
+	LockFreeDequeue<int> dequeue(4);
+	ASSERT_TRUE(dequeue.put(5));
+	dequeue.close();
+	ASSERT_EQ(dequeue.take(), 5);
+	ASSERT_THROW(dequeue.take(), DequeueClosedException);
+
+	LockFreeDequeue<int> waited(4);
+	std::thread closer([&waited]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_THREAD_TIME_MS));
+		waited.close();
+	});
+	ASSERT_THROW(waited.take(), DequeueClosedException);
+	closer.join();
+}
@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+#include "executor.h"
+#include "parallel.h"
+#include "workstealingexecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(ParallelUnitTest, chunks_is_cover_range_evenly) {
+	size_t n = 10, chunks = 3;
+	ASSERT_EQ(parallelChunkBegin(n, chunks, 0), 0u);
+	ASSERT_EQ(parallelChunkBegin(n, chunks, 1), 4u);
+	ASSERT_EQ(parallelChunkBegin(n, chunks, 2), 7u);
+	ASSERT_EQ(parallelChunkBegin(n, chunks, 3), 10u);
+
+	ASSERT_EQ(parallelChunkCount(0, 4, 0), 0u);
+	ASSERT_EQ(parallelChunkCount(3, 4, 0), 3u);
+	ASSERT_EQ(parallelChunkCount(1000, 4, 100), 10u);
+}
+
+TEST(ParallelUnitTest, parallelFor_is_visit_every_index_once) {
+	ThreadPoolExecutor executor(3);
+	vector<atomic<int>> visits(1000);
+	for (auto& visit : visits) visit.store(0);
+
+	parallelFor(executor, 0, 1000, [&](int i) { visits[static_cast<size_t>(i)].fetch_add(1); });
+	for (auto& visit : visits) ASSERT_EQ(visit.load(), 1);
+
+	parallelFor(executor, 0, 1000, [&](int i) { visits[static_cast<size_t>(i)].fetch_add(1); }, 7);
+	for (auto& visit : visits) ASSERT_EQ(visit.load(), 2);
+}
+
+TEST(ParallelUnitTest, parallelFor_is_rethrow_exception) {
+	ThreadPoolExecutor executor(2);
+	ASSERT_THROW(parallelFor(executor, 0, 100, [](int i) { if (i == 50) throw runtime_error("fail"); }, 1),
+	             runtime_error);
+}
+
+TEST(ParallelUnitTest, parallelFor_is_complete_nested_on_single_worker) {
+	ThreadPoolExecutor executor(1);
+	atomic<int> sum(0);
+	parallelFor(executor, 0, 10, [&](int) {
+		parallelFor(executor, 0, 10, [&](int j) { sum.fetch_add(j); }, 1);
+	}, 1);
+	ASSERT_EQ(sum.load(), 450);
+}
+
+TEST(ParallelUnitTest, parallelFor_is_run_on_shut_down_executor) {
+	ThreadPoolExecutor executor(2);
+	executor.shutdown();
+	atomic<int> count(0);
+	parallelFor(executor, 0, 100, [&](int) { count.fetch_add(1); }, 1);
+	ASSERT_EQ(count.load(), 100);
+}
+
+TEST(ParallelUnitTest, parallelFor_is_complete_when_helper_rejected) {
+	promise<void> release;
+	shared_future<void> released = release.get_future().share();
+	atomic<int> blocked(0);
+	ThreadPoolExecutor executor(2, 1, RejectionPolicy::abort);
+	for (int i = 0; i < 2; ++i) {
+		executor.execute([&blocked, released]() {
+			++blocked;
+			released.wait();
+		});
+		while (blocked.load() != i + 1) this_thread::yield();
+	}
+
+	vector<int> visits(100, 0);
+	parallelFor(executor, 0, 100, [&visits](int i) { ++visits[static_cast<size_t>(i)]; });
+	ASSERT_EQ(visits, vector<int>(100, 1));
+	release.set_value();
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+}
+
+TEST(ParallelUnitTest, parallelTransform_is_keep_order) {
+	WorkStealingThreadPoolExecutor executor(2);
+	vector<int> in(1000), out(1000);
+	for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<int>(i);
+
+	auto end = parallelTransform(executor, in.begin(), in.end(), out.begin(), [](int x) { return x * 2; });
+	ASSERT_TRUE(end == out.end());
+	for (size_t i = 0; i < out.size(); ++i) ASSERT_EQ(out[i], static_cast<int>(i) * 2);
+}
+
+TEST(ParallelUnitTest, parallelReduce_is_combine_chunks_in_order) {
+	ThreadPoolExecutor executor(3);
+	vector<int> values(10000);
+	for (size_t i = 0; i < values.size(); ++i) values[i] = static_cast<int>(i);
+	ASSERT_EQ(parallelReduce(executor, values.begin(), values.end(), 0L), 49995000L);
+
+	vector<string> letters;
+	for (char c = 'a'; c <= 'z'; ++c) letters.push_back(string(1, c));
+	string joined = parallelReduce(executor, letters.begin(), letters.end(), string(">"),
+	                               [](const string& a, const string& b) { return a + b; }, 3);
+	ASSERT_EQ(joined, ">abcdefghijklmnopqrstuvwxyz");
+}
+
+TEST(ParallelUnitTest, parallelSort_is_sort_like_std_sort) {
+	ThreadPoolExecutor executor(3);
+	mt19937 random(42);
+	for (size_t n : {0u, 1u, 5u, 1000u, 100003u}) {
+		vector<int> values(n);
+		for (auto& value : values) value = static_cast<int>(random() % 1000);
+		vector<int> expected = values;
+		sort(expected.begin(), expected.end());
+
+		vector<int> byGrain = values;
+		parallelSort(executor, values.begin(), values.end());
+		ASSERT_EQ(values, expected);
+		parallelSort(executor, byGrain.begin(), byGrain.end(), less<int>(), 100);
+		ASSERT_EQ(byGrain, expected);
+	}
+}
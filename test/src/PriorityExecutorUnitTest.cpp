@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "priorityexecutor.h"
+
+#include <future>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+struct PrioritizedInt {
+	int value;
+	int level;
+
+	int priority() const { return level; }
+};
+
+TEST(PriorityExecutorUnitTest, bucketQueue_is_return_higher_priority_first) {
+	PriorityBucketQueue<PrioritizedInt> queue;
+	queue.push_back(PrioritizedInt{1, 0});
+	queue.push_back(PrioritizedInt{2, 5});
+	queue.push_back(PrioritizedInt{3, 5});
+	queue.push_back(PrioritizedInt{4, 7});
+
+	std::vector<int> values;
+	while (!queue.empty()) {
+		values.push_back(queue.front().value);
+		queue.pop_front();
+	}
+	ASSERT_EQ(values, std::vector<int>({4, 2, 3, 1}));
+}
+
+TEST(PriorityExecutorUnitTest, bucketQueue_is_serve_starving_level) {
+	const size_t threshold = DefaultPriorityPolicy::AGING_THRESHOLD;
+	PriorityBucketQueue<PrioritizedInt> queue;
+	queue.push_back(PrioritizedInt{-1, 0});
+	for (size_t i = 0; i < threshold * 2; ++i) queue.push_back(PrioritizedInt{1, 7});
+
+	size_t position = 0;
+	while (queue.front().value != -1) {
+		queue.pop_front();
+		++position;
+	}
+	ASSERT_EQ(position, threshold);
+}
+
+TEST(PriorityExecutorUnitTest, bucketQueue_is_clamp_out_of_range_priorities) {
+	PriorityBucketQueue<PrioritizedInt> queue;
+	queue.push_back(PrioritizedInt{1, -5});
+	queue.push_back(PrioritizedInt{2, 0});
+	queue.push_back(PrioritizedInt{3, 100});
+	queue.push_back(PrioritizedInt{4, 7});
+
+	std::vector<int> values;
+	while (!queue.empty()) {
+		values.push_back(queue.front().value);
+		queue.pop_front();
+	}
+	ASSERT_EQ(values, std::vector<int>({3, 4, 1, 2}));
+	const int normPriority = PriorityTask::NORM_PRIORITY;
+	ASSERT_EQ(PriorityTask().priority(), normPriority);
+}
+
+TEST(PriorityExecutorUnitTest, execute_is_run_higher_priority_first) {
+	std::mutex mutex;
+	std::vector<int> order;
+	std::promise<void> blockerStarted;
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	{
+		PriorityThreadPoolExecutor executor(1);
+		executor.execute([&]() {
+			blockerStarted.set_value();
+			released.wait();
+		});
+		blockerStarted.get_future().wait();
+
+		for (int priority = PriorityTask::MIN_PRIORITY; priority <= PriorityTask::MAX_PRIORITY; ++priority) {
+			executor.execute(priority, [&, priority]() {
+				std::lock_guard<std::mutex> lock(mutex);
+				order.push_back(priority);
+			});
+		}
+		release.set_value();
+		executor.shutdown();
+		ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+	}
+	ASSERT_EQ(order, std::vector<int>({7, 6, 5, 4, 3, 2, 1, 0}));
+}
+
+TEST(PriorityExecutorUnitTest, shutdown_is_run_all_queued_tasks) {
+	const int count = 100;
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	PriorityThreadPoolExecutor executor(2);
+	for (int i = 0; i < count; ++i) {
+		executor.execute(i % (PriorityTask::MAX_PRIORITY + 1), [&]() {
+			released.wait();
+			++executed;
+		});
+	}
+	executor.shutdown();
+	release.set_value();
+	ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS * 10));
+	ASSERT_EQ(executed.load(), count);
+}
+
+TEST(PriorityExecutorUnitTest, submit_is_return_result) {
+	PriorityThreadPoolExecutor executor(1);
+	auto high = executor.submit(PriorityTask::MAX_PRIORITY, []() { return 1; });
+	auto normal = executor.submit([]() { return 2; });
+	ASSERT_EQ(high.get() + normal.get(), 3);
+}
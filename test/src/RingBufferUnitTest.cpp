@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "blockingdequeue.h"
+#include "ringbuffer.h"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Stateful allocator which counts its live allocations, allocators with different counters are not equal.
+ */
+template<typename T, bool Propagate_>
+struct CountingAllocator {
+	typedef T value_type;
+	typedef integral_constant<bool, Propagate_> propagate_on_container_move_assignment;
+
+	explicit CountingAllocator(shared_ptr<int> live) : live(std::move(live)) { }
+	// Moved allocator must stay equal to the source, so moving copies the counter
+	CountingAllocator(const CountingAllocator& other) = default;
+	template<typename U>
+	CountingAllocator(const CountingAllocator<U, Propagate_>& other) : live(other.live) { }
+
+	T* allocate(size_t n) {
+		++*live;
+		return allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, size_t n) {
+		--*live;
+		allocator<T>().deallocate(p, n);
+	}
+
+	template<typename U>
+	struct rebind { typedef CountingAllocator<U, Propagate_> other; };
+
+	shared_ptr<int> live;
+};
+
+template<typename T, typename U, bool Propagate_>
+bool operator==(const CountingAllocator<T, Propagate_>& a, const CountingAllocator<U, Propagate_>& b) {
+	return a.live == b.live;
+}
+
+template<typename T, typename U, bool Propagate_>
+bool operator!=(const CountingAllocator<T, Propagate_>& a, const CountingAllocator<U, Propagate_>& b) {
+	return !(a == b);
+}
+
+template<bool Propagate_>
+static void checkMoveAssignment() {
+	typedef CountingAllocator<string, Propagate_> Allocator;
+	shared_ptr<int> liveA = make_shared<int>(0), liveB = make_shared<int>(0);
+	{
+		RingBuffer<string, Allocator> a{Allocator(liveA)};
+		RingBuffer<string, Allocator> b{Allocator(liveB)};
+		a.push_back("old");
+		for (int i = 0; i < 10; ++i) b.push_back(to_string(i));
+		b.pop_front();
+
+		a = std::move(b);
+		ASSERT_EQ(a.size(), 9u);
+		for (size_t i = 0; i < a.size(); ++i) ASSERT_EQ(a.at(i), to_string(i + 1));
+		ASSERT_EQ(b.size(), 0u);
+		ASSERT_EQ(*liveA, Propagate_ ? 0 : 1);
+		ASSERT_EQ(*liveB, 1);
+
+		b.push_back("reused");
+		ASSERT_EQ(b.front(), "reused");
+	}
+	ASSERT_EQ(*liveA, 0);
+	ASSERT_EQ(*liveB, 0);
+}
+
+TEST(RingBufferUnitTest, push_pop_is_fifo_across_wrap_and_grow) {
+	RingBuffer<int> buffer;
+	int next = 0, expected = 0;
+	for (int round = 0; round < 10; ++round) {
+		for (int i = 0; i < 5 + round * 3; ++i) buffer.push_back(next++);
+		for (int i = 0; i < 4 + round * 2; ++i) {
+			ASSERT_EQ(buffer.front(), expected++);
+			buffer.pop_front();
+		}
+	}
+	ASSERT_EQ(buffer.size(), static_cast<size_t>(next - expected));
+	while (!buffer.empty()) {
+		ASSERT_EQ(buffer.front(), expected++);
+		buffer.pop_front();
+	}
+	ASSERT_EQ(expected, next);
+}
+
+TEST(RingBufferUnitTest, capacity_is_kept_when_size_oscillates) {
+	RingBuffer<int> buffer;
+	for (int i = 0; i < 100; ++i) buffer.push_back(i);
+	size_t capacity = buffer.capacity();
+	ASSERT_EQ(capacity, 128u);
+
+	for (int round = 0; round < 100; ++round) {
+		while (!buffer.empty()) buffer.pop_front();
+		for (int i = 0; i < 100; ++i) buffer.push_back(i);
+	}
+	ASSERT_EQ(buffer.capacity(), capacity);
+}
+
+TEST(RingBufferUnitTest, elements_is_destroyed_and_copied) {
+	shared_ptr<int> value = make_shared<int>(1);
+	{
+		RingBuffer<shared_ptr<int>> buffer;
+		for (int i = 0; i < 20; ++i) buffer.push_back(value);
+		buffer.pop_front();
+		RingBuffer<shared_ptr<int>> copy(buffer);
+		ASSERT_EQ(copy.size(), 19u);
+		ASSERT_EQ(value.use_count(), 39);
+
+		RingBuffer<shared_ptr<int>> moved(std::move(copy));
+		ASSERT_EQ(moved.size(), 19u);
+		ASSERT_EQ(copy.size(), 0u);
+	}
+	ASSERT_EQ(value.use_count(), 1);
+}
+
+TEST(RingBufferUnitTest, blockingDequeue_is_work_on_ring_buffer) {
+	BlockingDequeue<string, RingBuffer> dequeue(4);
+	vector<string> values = {"a", "b", "c", "d", "e"};
+	ASSERT_EQ(dequeue.offerAll(values.begin(), values.end()), 4u);
+	ASSERT_EQ(dequeue.take(), "a");
+	ASSERT_TRUE(dequeue.offer(string("e")));
+
+	vector<string> drained;
+	ASSERT_EQ(dequeue.drainTo(drained), 4u);
+	ASSERT_EQ(drained, vector<string>({"b", "c", "d", "e"}));
+}
+
+TEST(RingBufferUnitTest, moveAssignment_is_free_through_propagated_allocator) {
+	checkMoveAssignment<true>();
+}
+
+TEST(RingBufferUnitTest, moveAssignment_is_move_elements_when_allocator_not_propagated) {
+	checkMoveAssignment<false>();
+}
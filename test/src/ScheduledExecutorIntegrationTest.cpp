@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "scheduledexecutor.h"
+
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+TEST(ScheduledExecutorIntegrationTest, schedule_is_run_after_delay) {
+	ScheduledThreadPoolExecutor executor(1);
+	std::promise<steady_clock::time_point> ran;
+	auto start = steady_clock::now();
+	ScheduledHandle handle = executor.schedule(WAIT_THREAD_TIME_MS, [&]() { ran.set_value(steady_clock::now()); });
+	ASSERT_TRUE(handle);
+	auto future = ran.get_future();
+	ASSERT_EQ(future.wait_for(milliseconds(WAIT_THREAD_TIME_MS * 10)), std::future_status::ready);
+	ASSERT_GE(duration_cast<milliseconds>(future.get() - start).count(), WAIT_THREAD_TIME_MS);
+	this_thread::sleep_for(milliseconds(1));
+	ASSERT_TRUE(handle.isDone());
+	ASSERT_FALSE(handle.isCancelled());
+}
+
+TEST(ScheduledExecutorIntegrationTest, cancel_is_prevent_run) {
+	ScheduledThreadPoolExecutor executor(1);
+	std::atomic_bool isRun(false);
+	ScheduledHandle handle = executor.schedule(WAIT_THREAD_TIME_MS, [&]() { isRun = true; });
+	ASSERT_TRUE(handle.cancel());
+	ASSERT_FALSE(handle.cancel());
+	ASSERT_TRUE(handle.isCancelled());
+	ASSERT_EQ(executor.getScheduledCount(), 0);
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS * 2));
+	ASSERT_FALSE(isRun);
+}
+
+TEST(ScheduledExecutorIntegrationTest, scheduleAtFixedRate_is_run_periodically) {
+	ScheduledThreadPoolExecutor executor(1);
+	std::atomic_int runs(0);
+	ScheduledHandle handle = executor.scheduleAtFixedRate(0, 5, [&]() { ++runs; });
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS * 3));
+	ASSERT_TRUE(handle.cancel());
+	int runsAfterCancel = runs;
+	ASSERT_GE(runsAfterCancel, 3);
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+	ASSERT_LE(runs.load(), runsAfterCancel + 1);
+}
+
+TEST(ScheduledExecutorIntegrationTest, scheduleWithFixedDelay_is_wait_after_run) {
+	ScheduledThreadPoolExecutor executor(2);
+	std::atomic_int runs(0);
+	std::atomic_int running(0);
+	std::atomic_bool isOverlapped(false);
+	ScheduledHandle handle = executor.scheduleWithFixedDelay(0, 1, [&]() {
+		if (++running > 1) isOverlapped = true;
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS / 3));
+		--running;
+		++runs;
+	});
+	this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS * 3));
+	handle.cancel();
+	ASSERT_GE(runs.load(), 2);
+	ASSERT_LE(runs.load(), 9);
+	ASSERT_FALSE(isOverlapped);
+}
+
+TEST(ScheduledExecutorIntegrationTest, shutdown_is_cancel_waiting_tasks) {
+	std::atomic_bool isRun(false);
+	ScheduledHandle handle;
+	{
+		ScheduledThreadPoolExecutor executor(1);
+		handle = executor.schedule(WAIT_THREAD_TIME_MS * 100, [&]() { isRun = true; });
+		executor.shutdown();
+		ASSERT_TRUE(handle.isCancelled());
+		ASSERT_FALSE(executor.schedule(0, [&]() { isRun = true; }));
+		ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS));
+	}
+	ASSERT_FALSE(handle.cancel());
+	ASSERT_FALSE(isRun);
+}
+
+TEST(ScheduledExecutorIntegrationTest, shutdown_through_base_is_cancel_waiting_tasks) {
+	ScheduledThreadPoolExecutor executor(1);
+	ScheduledHandle handle = executor.scheduleAtFixedRate(WAIT_THREAD_TIME_MS * 100, 10, []() { });
+	ThreadPoolExecutorTemplate<std::thread, BlockingDequeue<FunctionWrapper, SlabDeque>>& base = executor;
+	base.shutdown();
+	ASSERT_TRUE(handle.isCancelled());
+	ASSERT_EQ(executor.getScheduledCount(), 0);
+	ASSERT_TRUE(executor.awaitTermination(WAIT_THREAD_TIME_MS));
+}
+
+TEST(ScheduledExecutorIntegrationTest, periodic_is_reject_non_positive_period) {
+	ScheduledThreadPoolExecutor executor(1);
+	ASSERT_THROW(executor.scheduleAtFixedRate(0, 0, []() { }), std::invalid_argument);
+	ASSERT_THROW(executor.scheduleWithFixedDelay(0, -1, []() { }), std::invalid_argument);
+	ASSERT_EQ(executor.getScheduledCount(), 0);
+}
+
+TEST(ScheduledExecutorIntegrationTest, schedule_is_keep_many_timers) {
+	const int count = 100000;
+	ScheduledThreadPoolExecutor executor(1);
+	std::vector<ScheduledHandle> handles;
+	handles.reserve(count);
+	for (int i = 0; i < count; ++i) handles.push_back(executor.schedule(60000 + i, []() { }));
+	ASSERT_EQ(executor.getScheduledCount(), count);
+	for (ScheduledHandle& handle : handles) ASSERT_TRUE(handle.cancel());
+	ASSERT_EQ(executor.getScheduledCount(), 0);
+}
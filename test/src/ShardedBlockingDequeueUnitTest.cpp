@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+#include "executor.h"
+#include "shardedblockingdequeue.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+TEST(ShardedBlockingDequeueUnitTest, per_producer_is_keep_order_of_each_producer) {
+	const int producers = 6;
+	const int count = 2000;
+	ShardedBlockingDequeue<pair<int, int>> dequeue(64, 4);
+	vector<thread> threads;
+	for (int p = 0; p < producers; ++p) {
+		threads.emplace_back([&dequeue, p]() {
+			for (int i = 0; i < count; ++i) ASSERT_TRUE(dequeue.put(make_pair(p, i)));
+		});
+	}
+
+	vector<int> next(producers, 0);
+	for (int i = 0; i < producers * count; ++i) {
+		pair<int, int> element = dequeue.take();
+		ASSERT_EQ(element.second, next[static_cast<size_t>(element.first)]++);
+	}
+	for (thread& t : threads) t.join();
+	ASSERT_EQ(dequeue.size(), 0);
+}
+
+TEST(ShardedBlockingDequeueUnitTest, many_producers_and_consumers_is_transfer_all) {
+	const int producers = 8;
+	const int consumers = 3;
+	const int count = 1000;
+	ShardedBlockingDequeue<int> dequeue(32, 4, ShardOrder::none);
+	atomic<long> sum(0);
+	atomic<int> taken(0);
+	vector<thread> threads;
+	for (int c = 0; c < consumers; ++c) {
+		threads.emplace_back([&]() {
+			int value;
+			while (dequeue.takeStatus(value) == DequeueStatus::ok) {
+				ASSERT_LE(dequeue.size(), static_cast<size_t>(producers * count));
+				sum.fetch_add(value);
+				taken.fetch_add(1);
+			}
+		});
+	}
+	vector<thread> putters;
+	for (int p = 0; p < producers; ++p) {
+		putters.emplace_back([&dequeue]() {
+			for (int i = 1; i <= count; ++i) dequeue.put(i);
+		});
+	}
+	for (thread& t : putters) t.join();
+	dequeue.close();
+	for (thread& t : threads) t.join();
+
+	ASSERT_EQ(taken.load(), producers * count);
+	ASSERT_EQ(sum.load(), static_cast<long>(producers) * count * (count + 1) / 2);
+	ASSERT_TRUE(dequeue.isDrained());
+}
+
+TEST(ShardedBlockingDequeueUnitTest, poll_is_timeout_and_wake_on_put) {
+	ShardedBlockingDequeue<int> dequeue(SIZE_MAX, 4);
+	int value = 0;
+	auto start = steady_clock::now();
+	ASSERT_EQ(dequeue.pollStatus(value, 20), DequeueStatus::timeout);
+	ASSERT_GE(steady_clock::now() - start, milliseconds(20));
+
+	bool isOk = true;
+	ASSERT_EQ(dequeue.poll(0, -1, &isOk), -1);
+	ASSERT_FALSE(isOk);
+
+	thread producer([&dequeue]() {
+		this_thread::sleep_for(milliseconds(10));
+		dequeue.put(42);
+	});
+	ASSERT_EQ(dequeue.pollStatus(value, 1000), DequeueStatus::ok);
+	ASSERT_EQ(value, 42);
+	producer.join();
+}
+
+TEST(ShardedBlockingDequeueUnitTest, offer_is_respect_capacity) {
+	ShardedBlockingDequeue<int> dequeue(4, 2, ShardOrder::none);
+	for (int i = 0; i < 4; ++i) ASSERT_TRUE(dequeue.offer(i));
+	ASSERT_FALSE(dequeue.offer(4));
+	ASSERT_EQ(dequeue.size(), 4);
+
+	int value;
+	ASSERT_TRUE(dequeue.tryPoll(value));
+	ASSERT_TRUE(dequeue.offer(4));
+}
+
+TEST(ShardedBlockingDequeueUnitTest, close_is_wake_takers_after_drain) {
+	ShardedBlockingDequeue<int> dequeue(SIZE_MAX, 3, ShardOrder::none);
+	for (int i = 0; i < 5; ++i) dequeue.put(i);
+
+	vector<int> drained;
+	ASSERT_EQ(dequeue.drainTo(drained, 2), 2);
+	ASSERT_EQ(dequeue.size(), 3);
+
+	dequeue.close();
+	ASSERT_FALSE(dequeue.put(5));
+	ASSERT_FALSE(dequeue.isDrained());
+	ASSERT_EQ(dequeue.drainTo(drained), 3);
+	ASSERT_EQ(drained.size(), 5);
+	ASSERT_TRUE(dequeue.isDrained());
+	ASSERT_THROW(dequeue.take(), DequeueClosedException);
+
+	ShardedBlockingDequeue<int> waited(SIZE_MAX, 2);
+	thread closer([&waited]() {
+		this_thread::sleep_for(milliseconds(10));
+		waited.close();
+	});
+	int value;
+	ASSERT_EQ(waited.takeStatus(value), DequeueStatus::closed);
+	closer.join();
+}
+
+TEST(ShardedBlockingDequeueUnitTest, putAll_is_keep_order_and_offerAll_respect_capacity) {
+	ShardedBlockingDequeue<int> dequeue(4, 2);
+	vector<int> values({1, 2, 3});
+	ASSERT_EQ(dequeue.offerAll(values.begin(), values.end()), 2);
+	ASSERT_EQ(dequeue.size(), 2);
+
+	thread consumer([&dequeue]() {
+		for (int expected : {1, 2, 4, 5, 6}) ASSERT_EQ(dequeue.take(), expected);
+	});
+	vector<int> more({4, 5, 6});
+	dequeue.putAll(more.begin(), more.end());
+	consumer.join();
+	ASSERT_EQ(dequeue.size(), 0);
+
+	ShardedBlockingDequeue<int> spread(4, 2, ShardOrder::none);
+	ASSERT_EQ(spread.offerAll(values.begin(), values.end()), 3);
+	ASSERT_EQ(spread.size(), 3);
+}
+
+TEST(ShardedBlockingDequeueUnitTest, executor_is_run_tasks_from_sharded_queue) {
+	ThreadPoolExecutorTemplate<std::thread, ShardedBlockingDequeue<FunctionWrapper>> executor(2);
+	atomic<int> counter(0);
+	vector<thread> producers;
+	for (int p = 0; p < 4; ++p) {
+		producers.emplace_back([&executor, &counter]() {
+			for (int i = 0; i < 100; ++i) executor.execute([&counter]() { counter.fetch_add(1); });
+		});
+	}
+	for (thread& t : producers) t.join();
+	ASSERT_EQ(executor.submit([]() { return 7; }).get(), 7);
+
+	vector<function<void()>> batch(50, [&counter]() { counter.fetch_add(1); });
+	executor.executeAll(batch.begin(), batch.end());
+	vector<function<int()>> callables(10, []() { return 2; });
+	vector<int> results = executor.submitAll(callables).get();
+	ASSERT_EQ(results, vector<int>(10, 2));
+
+	executor.shutdown();
+	ASSERT_TRUE(executor.awaitTermination(1000));
+	ASSERT_EQ(counter.load(), 450);
+}
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+#include "executor.h"
+#include "slaballocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static atomic<size_t> mallocCount(0);
+
+void* operator new(size_t size) {
+	mallocCount.fetch_add(1, memory_order_relaxed);
+	void* p = malloc(size ? size : 1);
+	if (!p) throw bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+TEST(SlabAllocatorUnitTest, block_is_reused_after_local_free) {
+	void* block = SlabAllocator::allocate(40);
+	SlabAllocator::deallocate(block);
+	size_t mallocs = mallocCount.load();
+	ASSERT_EQ(SlabAllocator::allocate(40), block);
+	ASSERT_EQ(mallocCount.load(), mallocs);
+	SlabAllocator::deallocate(block);
+}
+
+TEST(SlabAllocatorUnitTest, remote_free_returns_block_to_owner) {
+	thread owner([]() {
+		void* block = SlabAllocator::allocate(100);
+		thread([block]() { SlabAllocator::deallocate(block); }).join();
+
+		vector<void*> blocks;
+		for (size_t i = 1; i < SlabCache::BLOCKS_PER_CHUNK; ++i) blocks.push_back(SlabAllocator::allocate(100));
+		size_t mallocs = mallocCount.load();
+		ASSERT_EQ(SlabAllocator::allocate(100), block);
+		ASSERT_EQ(mallocCount.load(), mallocs);
+
+		blocks.push_back(block);
+		for (void* p : blocks) SlabAllocator::deallocate(p);
+	});
+	owner.join();
+}
+
+TEST(SlabAllocatorUnitTest, block_outlives_its_thread) {
+	int* block = nullptr;
+	thread([&block]() { block = static_cast<int*>(SlabAllocator::allocate(sizeof(int))); }).join();
+	*block = 42;
+	ASSERT_EQ(*block, 42);
+	SlabAllocator::deallocate(block);
+}
+
+TEST(SlabAllocatorUnitTest, large_block_is_allocated_with_operator_new) {
+	size_t mallocs = mallocCount.load();
+	void* block = SlabAllocator::allocate(SlabCache::MAX_BLOCK_SIZE + 1);
+	ASSERT_EQ(mallocCount.load(), mallocs + 1);
+	SlabAllocator::deallocate(block);
+}
+
+TEST(SlabAllocatorUnitTest, executor_does_not_malloc_in_steady_state) {
+	ThreadPoolExecutor executor(2);
+	atomic<int> sum(0);
+	vector<future<int>> futures;
+	futures.reserve(512);
+	auto submitRound = [&](int count) {
+		futures.clear();
+		for (int i = 0; i < count; ++i) futures.push_back(executor.submit([i]() { return i; }));
+		for (int i = 0; i < count; ++i) executor.execute([&sum]() { sum.fetch_add(1); });
+	};
+	auto waitRound = [&]() {
+		for (auto& f : futures) sum.fetch_add(f.get());
+		Future<int> future = executor.async([]() { return 1; });
+		sum.fetch_add(future.get());
+	};
+
+	// Warm-up with workers blocked, so queue and caches reach the peak which later rounds never exceed
+	atomic<bool> isOpen(false);
+	for (int i = 0; i < 2; ++i) executor.execute([&isOpen]() { while (!isOpen.load()) this_thread::yield(); });
+	submitRound(512);
+	isOpen.store(true);
+	waitRound();
+
+	size_t mallocs = mallocCount.load();
+	for (int i = 0; i < 100; ++i) {
+		submitRound(256);
+		waitRound();
+	}
+	ASSERT_EQ(mallocCount.load(), mallocs);
+	ASSERT_GT(sum.load(), 0);
+}
@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "spscdequeue.h"
+
+#include <deque>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace chrono;
+
+TEST(SpscDequeueUnitTest, offer_is_false_when_capacity_reach) {
+	SpscDequeue<int> dequeue(2);
+	EXPECT_TRUE(dequeue.offer(1));
+	EXPECT_TRUE(dequeue.offer(2));
+	ASSERT_FALSE(dequeue.offer(3));
+	ASSERT_EQ(dequeue.remainingCapacity(), 0);
+}
+
+TEST(SpscDequeueUnitTest, take_is_fifo) {
+	SpscDequeue<int> dequeue(4);
+	dequeue.put(111);
+	dequeue.put(222);
+	ASSERT_EQ(dequeue.take(), 111);
+	ASSERT_EQ(dequeue.take(), 222);
+	ASSERT_EQ(dequeue.size(), 0);
+}
+
+TEST(SpscDequeueUnitTest, poll_timeouted_is_default_value_when_empty) {
+	SpscDequeue<std::string> dequeue(4);
+	bool isOk = true;
+	auto start_time = steady_clock::now();
+	ASSERT_EQ(dequeue.poll(WAIT_THREAD_TIME_MS, std::string("default"), &isOk), "default");
+	ASSERT_FALSE(isOk);
+	ASSERT_GE(duration_cast<milliseconds>(steady_clock::now() - start_time).count(), WAIT_THREAD_TIME_MS);
+}
+
+TEST(SpscDequeueUnitTest, offer2_is_false_when_timeout) {
+	SpscDequeue<int> dequeue(2);
+	dequeue.put(1);
+	dequeue.put(2);
+	ASSERT_FALSE(dequeue.offer(3, WAIT_THREAD_TIME_MS));
+}
+
+TEST(SpscDequeueUnitTest, drainTo_is_elements_moved) {
+	SpscDequeue<int> dequeue(4);
+	dequeue.put(111);
+	dequeue.put(222);
+	std::deque<int> other;
+	ASSERT_EQ(dequeue.drainTo(other), 2);
+	ASSERT_EQ(other, std::deque<int>({111, 222}));
+}
+
+TEST(SpscDequeueUnitTest, take_is_unblocked_by_put) {
+	SpscDequeue<int> dequeue(4);
+	std::thread producer([&dequeue]() {
+		this_thread::sleep_for(milliseconds(WAIT_THREAD_TIME_MS));
+		dequeue.put(111);
+	});
+	ASSERT_EQ(dequeue.take(), 111);
+	producer.join();
+}
+
+TEST(SpscDequeueUnitTest, transfer_is_ordered) {
+	const int count = 200000;
+	SpscDequeue<int> dequeue(16);
+	std::thread producer([&dequeue]() {
+		for (int i = 0; i < count; ++i) dequeue.put(i);
+	});
+	int expected = 0;
+	for (; expected < count; ++expected) {
+		if (dequeue.take() != expected) break;
+	}
+	producer.join();
+	ASSERT_EQ(expected, count);
+}
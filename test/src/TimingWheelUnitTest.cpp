@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "timingwheel.h"
+
+#include <vector>
+
+using namespace std;
+
+struct TestTimer: public TimerNode {
+	explicit TestTimer(uint64_t deadline) {
+		this->deadline = deadline;
+	}
+};
+
+static std::vector<uint64_t> advanceTo(TimingWheel& wheel, uint64_t now) {
+	std::vector<uint64_t> expired;
+	wheel.advance(now, [&](TimerNode* node) {
+		expired.push_back(node->deadline);
+		EXPECT_EQ(node->deadline, wheel.now());
+	});
+	return expired;
+}
+
+TEST(TimingWheelUnitTest, advance_is_expire_in_deadline_order) {
+	TimingWheel wheel;
+	std::vector<TestTimer> timers;
+	for (uint64_t deadline : {5000u, 3u, 70u, 300000u, 64u, 4096u, 63u}) timers.emplace_back(deadline);
+	for (TestTimer& timer : timers) wheel.insert(&timer);
+	ASSERT_EQ(wheel.size(), timers.size());
+
+	ASSERT_EQ(advanceTo(wheel, 400000), std::vector<uint64_t>({3, 63, 64, 70, 4096, 5000, 300000}));
+	ASSERT_EQ(wheel.size(), 0);
+}
+
+TEST(TimingWheelUnitTest, advance_is_not_expire_before_deadline) {
+	TimingWheel wheel(100);
+	TestTimer timer(100 + 64 * 64 + 1);
+	wheel.insert(&timer);
+	ASSERT_TRUE(advanceTo(wheel, timer.deadline - 1).empty());
+	ASSERT_TRUE(timer.isLinked());
+	ASSERT_EQ(advanceTo(wheel, timer.deadline).size(), 1);
+	ASSERT_FALSE(timer.isLinked());
+}
+
+TEST(TimingWheelUnitTest, insert_is_expire_past_deadline_on_next_tick) {
+	TimingWheel wheel(10);
+	TestTimer timer(1);
+	wheel.insert(&timer);
+	ASSERT_EQ(wheel.nextTick(), 11);
+	ASSERT_EQ(advanceTo(wheel, 11), std::vector<uint64_t>({11}));
+}
+
+TEST(TimingWheelUnitTest, remove_is_not_expire) {
+	TimingWheel wheel;
+	TestTimer removed(10);
+	TestTimer kept(20);
+	wheel.insert(&removed);
+	wheel.insert(&kept);
+	wheel.remove(&removed);
+	ASSERT_EQ(advanceTo(wheel, 100), std::vector<uint64_t>({20}));
+}
+
+TEST(TimingWheelUnitTest, insert_is_expire_deadline_beyond_top_level) {
+	const uint64_t span = uint64_t(1) << (TimingWheel::SLOT_BITS * TimingWheel::LEVELS);
+	TimingWheel wheel;
+	TestTimer timer(span * 3 + 5);
+	wheel.insert(&timer);
+	ASSERT_TRUE(advanceTo(wheel, span * 3 + 4).empty());
+	ASSERT_EQ(advanceTo(wheel, span * 3 + 5).size(), 1);
+}
+
+TEST(TimingWheelUnitTest, nextTick_is_return_nearest_deadline_or_turn) {
+	TimingWheel wheel(60);
+	ASSERT_EQ(wheel.nextTick(), UINT64_MAX);
+	TestTimer far(1000);
+	wheel.insert(&far);
+	ASSERT_EQ(wheel.nextTick(), 64);
+	TestTimer near(62);
+	wheel.insert(&near);
+	ASSERT_EQ(wheel.nextTick(), 62);
+}
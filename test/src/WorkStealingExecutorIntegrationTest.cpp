@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "testutil.h"
+#include "workstealingexecutor.h"
+
+#include <future>
+#include <vector>
+
+using namespace std;
+using namespace chrono;
+
+TEST(WorkStealingDequeUnitTest, pop_is_lifo) {
+	WorkStealingDeque<int*> deque(2);
+	int values[3];
+	for (int& value : values) deque.push(&value);
+	int* v = nullptr;
+	ASSERT_TRUE(deque.pop(v));
+	ASSERT_EQ(v, &values[2]);
+}
+
+TEST(WorkStealingDequeUnitTest, steal_is_fifo) {
+	WorkStealingDeque<int*> deque(2);
+	int values[3];
+	for (int& value : values) deque.push(&value);
+	int* v = nullptr;
+	ASSERT_TRUE(deque.steal(v));
+	ASSERT_EQ(v, &values[0]);
+	ASSERT_EQ(deque.size(), 2);
+}
+
+TEST(WorkStealingDequeUnitTest, steal_is_false_when_empty) {
+	WorkStealingDeque<int*> deque;
+	int* v = nullptr;
+	ASSERT_FALSE(deque.steal(v));
+	ASSERT_FALSE(deque.pop(v));
+}
+
+TEST(WorkStealingExecutorIntegrationTest, execute_is_runnable_invoke) {
+	std::atomic_int invokedRunnables(0);
+	WorkStealingThreadPoolExecutor executorService(THREAD_COUNT);
+	for (int i = 0; i < 1000; ++i) executorService.execute([&]() { invokedRunnables++; });
+	executorService.shutdown();
+	ASSERT_TRUE(executorService.awaitTermination(1000));
+	ASSERT_EQ(invokedRunnables, 1000);
+}
+
+TEST(WorkStealingExecutorIntegrationTest, submit_is_future_ready) {
+	WorkStealingThreadPoolExecutor executorService(THREAD_COUNT);
+	auto future = executorService.submit([]() { return 42; });
+	ASSERT_EQ(future.get(), 42);
+}
+
+TEST(WorkStealingExecutorIntegrationTest, execute_is_nested_tasks_invoke) {
+	std::atomic_int invokedRunnables(0);
+	WorkStealingThreadPoolExecutor executorService(4);
+	std::function<void(int)> spawn = [&](int depth) {
+		invokedRunnables++;
+		if (depth == 0) return;
+		executorService.execute([&spawn, depth]() { spawn(depth - 1); });
+		executorService.execute([&spawn, depth]() { spawn(depth - 1); });
+	};
+	executorService.execute([&spawn]() { spawn(10); });
+	auto start_time = steady_clock::now();
+	while (invokedRunnables < (1 << 11) - 1 && steady_clock::now() - start_time < seconds(5)) {
+		this_thread::sleep_for(milliseconds(1));
+	}
+	ASSERT_EQ(invokedRunnables, (1 << 11) - 1);
+}
+
+TEST(WorkStealingExecutorIntegrationTest, execute_is_not_execute_after_shutdown) {
+	std::atomic_bool isRunnableInvoke(false);
+	WorkStealingThreadPoolExecutor executorService(1);
+	executorService.shutdown();
+	executorService.execute([&]() { isRunnableInvoke = true; });
+	ASSERT_TRUE(executorService.awaitTermination(1000));
+	ASSERT_FALSE(isRunnableInvoke);
+}
+
+TEST(WorkStealingExecutorIntegrationTest, awaitTermination_is_false_when_timeout) {
+	WorkStealingThreadPoolExecutor executorService(1);
+	executorService.execute([]() { this_thread::sleep_for(milliseconds(3 * WAIT_THREAD_TIME_MS)); });
+	executorService.shutdown();
+	ASSERT_FALSE(executorService.awaitTermination(WAIT_THREAD_TIME_MS));
+	ASSERT_TRUE(executorService.awaitTermination(10 * WAIT_THREAD_TIME_MS));
+}
+
+TEST(WorkStealingExecutorIntegrationTest, shutdownNow_is_run_queued_tasks) {
+	std::atomic_int executed(0);
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	std::vector<std::future<int>> futures;
+	{
+		WorkStealingThreadPoolExecutor executorService(1);
+		executorService.execute([released]() { released.wait(); });
+		for (int i = 0; i < 10; ++i) futures.push_back(executorService.submit([&executed, i]() { ++executed; return i; }));
+		executorService.shutdownNow();
+		release.set_value();
+		ASSERT_TRUE(executorService.awaitTermination(1000));
+		for (int i = 0; i < 10; ++i) ASSERT_EQ(futures[static_cast<size_t>(i)].get(), i);
+	}
+	std::promise<void> destructorRelease;
+	std::shared_future<void> destructorReleased = destructorRelease.get_future().share();
+	{
+		WorkStealingThreadPoolExecutor executorService(1);
+		executorService.execute([destructorReleased]() { destructorReleased.wait(); });
+		for (int i = 0; i < 10; ++i) executorService.execute([&executed]() { ++executed; });
+		destructorRelease.set_value();
+	}
+	ASSERT_EQ(executed.load(), 20);
+}